@@ -0,0 +1,27 @@
+#include "bench.h"
+#include <cstdlib>
+#include <new>
+
+// --- Allocation count ---
+// The bench tool replaces the global operator new, so a benchmark can check
+// that a loop never touches the heap. The array forms forward to these by
+// default. Counted per thread, the grid's workers allocate while a
+// benchmark runs.
+namespace {
+thread_local size_t allocations = 0;
+} // namespace
+
+void *operator new(size_t size) {
+  allocations++;
+  if (void *p = std::malloc(size == 0 ? 1 : size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+
+namespace bench {
+size_t GetAllocationCount() { return allocations; }
+} // namespace bench
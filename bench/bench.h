@@ -0,0 +1,50 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include "GFX_manager.h"
+#include "hex_tile_grid.h"
+#include <cstddef>
+
+/* --- Bench ---
+ * Microbenchmarks of the engine, run by the bench tool and never linked into
+ * the game. Each prints its results to stdout.
+ *
+ * GridBench and GFXBench are friends of HexGrid and GFX_Manager, they time
+ * the internals the frame loop runs.
+ */
+class GridBench {
+public:
+  // Times a walk over the visible window and neighbor queries in row-major
+  // and Morton tile order, prints the results.
+  static void TileOrder(const HexGrid &g);
+  // Times tile <-> point conversion per call, in scalar batches, in the
+  // SIMD batches and a row at a time as LoadBackBuffer() runs it, prints
+  // the cost per tile.
+  static void CoordConversion(const HexGrid &g);
+  // Times neighbor queries through a std::vector, as collision checks used
+  // to build them, against the hexmath iterators, and counts their heap
+  // allocations. Returns false if an iterator allocated.
+  static bool HexIterators(const HexGrid &g);
+  // Times walkability and area queries on the tile data against the bit
+  // layers, and the cost of building a chunk's layers.
+  static void TileBits(const HexGrid &g);
+};
+
+class GFXBench {
+public:
+  // Times std::sort, as RenderLayer() used to run it, against the radix
+  // sort on a layer of tile details and one out-of-order object.
+  static void LayerSort(GFX_Manager &gfx);
+};
+
+namespace bench {
+// Calls of the global operator new on this thread so far, see
+// alloc_count.cpp.
+size_t GetAllocationCount();
+
+// Times HexMap, std::unordered_map and std::map from 1K entries up to
+// 'maxEntries', prints the cost per operation. std::map stops at 1M.
+void HexMaps(size_t maxEntries);
+} // namespace bench
+
+#endif // !BENCH_H
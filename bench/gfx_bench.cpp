@@ -0,0 +1,76 @@
+#include "GFX_manager.h"
+#include "bench.h"
+#include "defines.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace {
+// Keeps the sorted layers from being optimized out.
+volatile float benchSink;
+} // namespace
+
+void GFXBench::LayerSort(GFX_Manager &gfx) {
+  using Clock = std::chrono::high_resolution_clock;
+  constexpr int ROWS = 70;
+  constexpr int TILES_PER_ROW = 60;
+  constexpr int RUNS = 50;
+
+  // Tiles row by row, and two commands per tile jittered like details and
+  // resources with the player last
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<float> jitter(-8.0f, 8.0f);
+  std::vector<gfx::Command> tiles;
+  std::vector<gfx::Command> layer;
+  for (int r = 0; r < ROWS; r++) {
+    for (int i = 0; i < TILES_PER_ROW; i++) {
+      gfx::Command c = {};
+      c.sortY = r * conf::TILE_SPACING_Y;
+      tiles.push_back(c);
+      c.sortY += jitter(rng);
+      layer.push_back(c);
+      c.sortY = r * conf::TILE_SPACING_Y + jitter(rng);
+      layer.push_back(c);
+    }
+  }
+  gfx::Command player = {};
+  player.sortY = ROWS / 2 * conf::TILE_SPACING_Y;
+  layer.push_back(player);
+
+  auto time = [&](const std::vector<gfx::Command> &input, auto &&sort) {
+    double total = 0.0;
+    for (int run = 0; run < RUNS; run++) {
+      std::vector<gfx::Command> copy = input;
+      auto start = Clock::now();
+      sort(copy);
+      std::chrono::duration<double, std::micro> elapsed = Clock::now() - start;
+      total += elapsed.count();
+      benchSink = copy[copy.size() / 2].sortY;
+    }
+    return total / RUNS;
+  };
+
+  double stdSort = time(layer, [](std::vector<gfx::Command> &l) {
+    std::sort(l.begin(), l.end(),
+              [](const gfx::Command &a, const gfx::Command &b) {
+                return a.sortY < b.sortY;
+              });
+  });
+  double radixSort =
+      time(layer, [&gfx](std::vector<gfx::Command> &l) { gfx.SortLayer(l); });
+  double check = time(tiles, [](std::vector<gfx::Command> &l) {
+    benchSink = std::is_sorted(
+        l.begin(), l.end(), [](const gfx::Command &a, const gfx::Command &b) {
+          return a.sortY < b.sortY;
+        });
+  });
+
+  std::cout << "Layer sort, us per frame, " << sizeof(gfx::Command)
+            << " B per command:" << std::endl
+            << "  " << layer.size() << " commands: std::sort " << stdSort
+            << ", radix " << radixSort << std::endl
+            << "  " << tiles.size() << " presorted tiles: check " << check
+            << std::endl;
+}
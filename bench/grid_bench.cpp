@@ -0,0 +1,423 @@
+#include "bench.h"
+#include "chunk_store.h"
+#include "defines.h"
+#include "hex_math.h"
+#include "hex_tile_grid.h"
+#include "map_tile.h"
+#include "raylib.h"
+#include "tile_bits.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+namespace {
+// splitmix64 finaliser, like the grid's tile hash.
+u64 Mix(u64 x) {
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ULL;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebULL;
+  x ^= x >> 31;
+  return x;
+}
+
+// Resource planes of a box of chunks, as the store lays them out. 'order'
+// picks the tile order inside a chunk.
+struct TilePlane {
+  u16 order;
+  int q0, r0; // First tile of the box, chunk aligned
+  int chunksQ;
+  std::vector<pack::Resource> rsrc;
+
+  int Index(int q, int r) const {
+    int sq = q - q0;
+    int sr = r - r0;
+    int lq = sq & chunk::MASK;
+    int lr = sr & chunk::MASK;
+    int local = order == chunk::MORTON ? chunk::MortonIndex(lq, lr)
+                                       : lr * chunk::SIZE + lq;
+    int c = (sr >> chunk::SHIFT) * chunksQ + (sq >> chunk::SHIFT);
+    return c * chunk::TILES + local;
+  }
+};
+
+// Keeps the timed reads from being optimized out.
+volatile u32 benchSink;
+} // namespace
+
+void GridBench::TileOrder(const HexGrid &g) {
+  using Clock = std::chrono::high_resolution_clock;
+  const VisibleWindow &w = g.currentVisibleWindow;
+  if (w.rMin > w.rMax) {
+    return;
+  }
+  int qLo = *std::min_element(w.qMin.begin(), w.qMin.end()) - 1;
+  int qHi = *std::max_element(w.qMax.begin(), w.qMax.end()) + 1;
+  int cq0 = g.chunks.ChunkCoord(qLo);
+  int cr0 = g.chunks.ChunkCoord(w.rMin - 1);
+  int chunksQ = g.chunks.ChunkCoord(qHi) - cq0 + 1;
+  int chunksR = g.chunks.ChunkCoord(w.rMax + 1) - cr0 + 1;
+
+  // Scattered queries run on a box far larger than the caches
+  constexpr int BIG_CHUNKS = 64;
+  constexpr int PASSES = 200;
+  constexpr int QUERIES = 200000;
+  std::vector<HexCoord> scattered(QUERIES);
+  u64 seed = g.worldSeed;
+  for (HexCoord &h : scattered) {
+    seed = Mix(seed);
+    h.q = 1 + (int)(seed % (BIG_CHUNKS * chunk::SIZE - 2));
+    h.r = 1 + (int)((seed >> 32) % (BIG_CHUNKS * chunk::SIZE - 2));
+  }
+
+  std::cout << "Tile order, " << w.tileCount << " visible tiles in "
+            << chunksQ * chunksR << " chunks:" << std::endl;
+  for (u16 order : {chunk::ROW_MAJOR, chunk::MORTON}) {
+    TilePlane p = {order, g.chunks.ChunkOrigin(cq0),
+                   g.chunks.ChunkOrigin(cr0), chunksQ, {}};
+    p.rsrc.assign((size_t)chunksQ * chunksR * chunk::TILES, 0);
+    u32 sum = 0;
+
+    // Cache lines a tile and its neighbors touch
+    int lines = 0;
+    for (int r = w.rMin; r <= w.rMax; r++) {
+      for (int q = w.qMin[r - w.rMin]; q <= w.qMax[r - w.rMin]; q++) {
+        int seen[7];
+        int n = 0;
+        seen[n++] = p.Index(q, r) * sizeof(pack::Resource) / 64;
+        for (const HexCoord &d : hexmath::DIRECTIONS) {
+          int line = p.Index(q + d.q, r + d.r) * sizeof(pack::Resource) / 64;
+          if (std::find(seen, seen + n, line) == seen + n) {
+            seen[n++] = line;
+          }
+        }
+        lines += n;
+      }
+    }
+
+    auto start = Clock::now();
+    for (int pass = 0; pass < PASSES; pass++) {
+      for (int r = w.rMin; r <= w.rMax; r++) {
+        for (int q = w.qMin[r - w.rMin]; q <= w.qMax[r - w.rMin]; q++) {
+          sum += p.rsrc[p.Index(q, r)];
+        }
+      }
+    }
+    std::chrono::duration<double, std::micro> walk = Clock::now() - start;
+
+    start = Clock::now();
+    for (int pass = 0; pass < PASSES; pass++) {
+      for (int r = w.rMin; r <= w.rMax; r++) {
+        for (int q = w.qMin[r - w.rMin]; q <= w.qMax[r - w.rMin]; q++) {
+          for (const HexCoord &d : hexmath::DIRECTIONS) {
+            sum += p.rsrc[p.Index(q + d.q, r + d.r)];
+          }
+        }
+      }
+    }
+    std::chrono::duration<double, std::micro> near = Clock::now() - start;
+
+    TilePlane big = {order, 0, 0, BIG_CHUNKS, {}};
+    big.rsrc.assign((size_t)BIG_CHUNKS * BIG_CHUNKS * chunk::TILES, 0);
+    start = Clock::now();
+    for (const HexCoord &h : scattered) {
+      for (const HexCoord &d : hexmath::DIRECTIONS) {
+        sum += big.rsrc[big.Index(h.q + d.q, h.r + d.r)];
+      }
+    }
+    std::chrono::duration<double, std::nano> far = Clock::now() - start;
+
+    std::cout << (order == chunk::MORTON ? "  morton:    " : "  row-major: ")
+              << "walk " << walk.count() / PASSES << " us, neighbors "
+              << near.count() / PASSES << " us ("
+              << (double)lines / w.tileCount << " lines/tile), scattered "
+              << far.count() / QUERIES << " ns/query" << std::endl;
+    benchSink = sum;
+  }
+}
+
+void GridBench::CoordConversion(const HexGrid &g) {
+  using Clock = std::chrono::high_resolution_clock;
+  constexpr int TILES = 4096;
+  constexpr int ROW = 64; // Tiles per span for RowToPoints
+  constexpr int PASSES = 500;
+  constexpr int SPREAD = 200;
+
+  // Spans of ROW tiles around the origin tile, as LoadBackBuffer() walks
+  // them, and points anywhere inside the tiles
+  std::vector<int> q(TILES), r(TILES), qOut(TILES), rOut(TILES);
+  std::vector<int> qRef(TILES), rRef(TILES);
+  std::vector<float> x(TILES), y(TILES), xRef(TILES), yRef(TILES);
+  std::vector<float> px(TILES), py(TILES);
+  u64 seed = g.worldSeed;
+  for (int i = 0; i < TILES; i += ROW) {
+    seed = Mix(seed);
+    int q0 = (int)(seed % (2 * SPREAD + 1)) - SPREAD;
+    int r0 = (int)((seed >> 32) % (2 * SPREAD + 1)) - SPREAD;
+    for (int k = 0; k < ROW; k++) {
+      seed = Mix(seed);
+      q[i + k] = q0 + k;
+      r[i + k] = r0;
+      Vector2 p = hexmath::ToPoint(g.hexLayout, q0 + k, r0);
+      px[i + k] = p.x + (float)((seed >> 16) % 200) / 10.0f - 10.0f;
+      py[i + k] = p.y + (float)((seed >> 48) % 200) / 10.0f - 10.0f;
+    }
+  }
+
+  auto time = [&](auto &&convert) {
+    auto start = Clock::now();
+    for (int pass = 0; pass < PASSES; pass++) {
+      convert();
+    }
+    std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+    return elapsed.count() / ((double)PASSES * TILES);
+  };
+
+  double pointCall = time([&] {
+    for (int i = 0; i < TILES; i++) {
+      Vector2 p =
+          g.CoordToPoint(q[i] + g.originTile.q, r[i] + g.originTile.r);
+      xRef[i] = p.x;
+      yRef[i] = p.y;
+    }
+  });
+  double pointScalar = time([&] {
+    hexmath::ToPointsScalar(g.hexLayout, q.data(), r.data(), TILES,
+                            xRef.data(), yRef.data());
+  });
+  double pointBatch = time([&] {
+    hexmath::ToPoints(g.hexLayout, q.data(), r.data(), TILES, x.data(),
+                      y.data());
+  });
+  int mismatches = 0;
+  for (int i = 0; i < TILES; i++) {
+    mismatches += x[i] != xRef[i] || y[i] != yRef[i];
+  }
+  double pointRows = time([&] {
+    for (int i = 0; i < TILES; i += ROW) {
+      hexmath::RowToPoints(g.hexLayout, q[i], r[i], ROW, x.data() + i,
+                           y.data() + i);
+    }
+  });
+  for (int i = 0; i < TILES; i++) {
+    mismatches += x[i] != xRef[i] || y[i] != yRef[i];
+  }
+
+  double coordCall = time([&] {
+    for (int i = 0; i < TILES; i++) {
+      HexCoord h = g.PointToHexCoord({px[i], py[i]});
+      qRef[i] = h.q - g.originTile.q;
+      rRef[i] = h.r - g.originTile.r;
+    }
+  });
+  double coordScalar = time([&] {
+    hexmath::ToCoordsScalar(g.hexLayout, px.data(), py.data(), TILES,
+                            qRef.data(), rRef.data());
+  });
+  double coordBatch = time([&] {
+    hexmath::ToCoords(g.hexLayout, px.data(), py.data(), TILES, qOut.data(),
+                      rOut.data());
+  });
+  for (int i = 0; i < TILES; i++) {
+    mismatches += qOut[i] != qRef[i] || rOut[i] != rRef[i];
+  }
+
+  std::cout << "Coord conversion (" << hexmath::GetKernelName() << "), "
+            << TILES << " tiles, ns per tile:" << std::endl
+            << "  to point: call " << pointCall << ", scalar " << pointScalar
+            << ", batch " << pointBatch << ", rows " << pointRows
+            << std::endl
+            << "  to tile:  call " << coordCall << ", scalar " << coordScalar
+            << ", batch " << coordBatch << std::endl
+            << "  batch/scalar mismatches: " << mismatches << std::endl;
+  benchSink = (u32)x[TILES - 1] + (u32)qOut[TILES - 1];
+}
+
+bool GridBench::HexIterators(const HexGrid &g) {
+  using Clock = std::chrono::high_resolution_clock;
+  constexpr int QUERIES = 100000;
+  constexpr int RADIUS = 3;
+  constexpr int LINE = 10;
+
+  std::vector<HexCoord> centers(QUERIES);
+  u64 seed = g.worldSeed;
+  for (HexCoord &h : centers) {
+    seed = Mix(seed);
+    h = HexCoord((int)(seed % 2001) - 1000, (int)((seed >> 32) % 2001) - 1000);
+  }
+
+  u32 sum = 0;
+  struct Result {
+    double ns;     // Per query
+    double allocs; // Per query
+  };
+  auto time = [&](auto &&visit) {
+    size_t allocs = bench::GetAllocationCount();
+    auto start = Clock::now();
+    for (const HexCoord &c : centers) {
+      visit(c);
+    }
+    std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+    allocs = bench::GetAllocationCount() - allocs;
+    return Result{elapsed.count() / QUERIES, (double)allocs / QUERIES};
+  };
+
+  // Center and neighbors, the old way
+  Result vector = time([&](HexCoord c) {
+    std::vector<HexCoord> neighbors;
+    neighbors.push_back(c);
+    for (int i = 0; i < 6; i++) {
+      neighbors.push_back(g.GetNeighbor(c, i));
+    }
+    for (const HexCoord &h : neighbors) {
+      sum += h.q ^ h.r;
+    }
+  });
+  Result spiral = time([&](HexCoord c) {
+    for (HexCoord h : hexmath::Spiral(c, 1)) {
+      sum += h.q ^ h.r;
+    }
+  });
+  Result ring = time([&](HexCoord c) {
+    for (HexCoord h : hexmath::Ring(c, RADIUS)) {
+      sum += h.q ^ h.r;
+    }
+  });
+  Result range = time([&](HexCoord c) {
+    for (HexCoord h : hexmath::Range(c, RADIUS)) {
+      sum += h.q ^ h.r;
+    }
+  });
+  Result line = time([&](HexCoord c) {
+    for (HexCoord h : hexmath::Line(c, c + HexCoord(LINE, -LINE / 2))) {
+      sum += h.q ^ h.r;
+    }
+  });
+
+  std::cout << "Hex iterators, ns / allocations per query:" << std::endl
+            << "  center + neighbors: vector " << vector.ns << " / "
+            << vector.allocs << ", spiral " << spiral.ns << " / "
+            << spiral.allocs << std::endl
+            << "  ring " << RADIUS << ": " << ring.ns << " / " << ring.allocs
+            << ", range " << RADIUS << ": " << range.ns << " / "
+            << range.allocs << ", line " << LINE << ": " << line.ns << " / "
+            << line.allocs << std::endl;
+  benchSink = sum;
+
+  bool heapFree = spiral.allocs == 0 && ring.allocs == 0 &&
+                  range.allocs == 0 && line.allocs == 0;
+  if (!heapFree) {
+    std::cout << "Error: hex iterators allocated" << std::endl;
+  }
+  return heapFree;
+}
+
+void GridBench::TileBits(const HexGrid &g) {
+  using Clock = std::chrono::high_resolution_clock;
+  constexpr int QUERIES = 100000;
+  constexpr int AREA_QUERIES = 1000;
+  constexpr int SPREAD = 256; // Tiles around the origin tile
+  constexpr int RADIUS = 3;
+  constexpr int AREA = 16;
+
+  std::vector<HexCoord> centers(QUERIES);
+  u64 seed = g.worldSeed;
+  for (HexCoord &h : centers) {
+    seed = Mix(seed);
+    h = g.originTile + HexCoord((int)(seed % (2 * SPREAD + 1)) - SPREAD,
+                              (int)((seed >> 32) % (2 * SPREAD + 1)) - SPREAD);
+  }
+
+  // Layers of its own, built from the grid's tiles, so the grid's cache is
+  // left as the game had it
+  ::TileBits bits;
+  bits.Init(&g.chunks, [&g](int cq, int cr, tilebits::ChunkBits &b) {
+    g.BuildTileBits(cq, cr, b);
+  });
+
+  // Building every chunk of the area, cold
+  int cqMin = g.chunks.ChunkCoord(g.originTile.q - SPREAD - AREA);
+  int cqMax = g.chunks.ChunkCoord(g.originTile.q + SPREAD + AREA);
+  int crMin = g.chunks.ChunkCoord(g.originTile.r - SPREAD - AREA);
+  int crMax = g.chunks.ChunkCoord(g.originTile.r + SPREAD + AREA);
+  auto start = Clock::now();
+  for (int cr = crMin; cr <= crMax; cr++) {
+    for (int cq = cqMin; cq <= cqMax; cq++) {
+      bits.Test(HexCoord(g.chunks.ChunkOrigin(cq), g.chunks.ChunkOrigin(cr)),
+                tilebits::WALKABLE);
+    }
+  }
+  std::chrono::duration<double, std::micro> buildTime = Clock::now() - start;
+  int built = bits.GetChunksBuilt();
+
+  u32 sum = 0;
+  int mismatches = 0;
+  auto time = [&](int count, auto &&query) {
+    auto start = Clock::now();
+    for (int i = 0; i < count; i++) {
+      query(centers[i]);
+    }
+    std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+    return elapsed.count() / count;
+  };
+
+  // The tile data reads the queries used before the layers
+  auto isWalkable = [&g](HexCoord h) {
+    if (!g.HasTile(h)) {
+      return false;
+    }
+    tile::id type = g.PeekID(h);
+    for (tile::id walkable : conf::WALKABLE_TILE_IDS) {
+      if (type == walkable) {
+        return true;
+      }
+    }
+    return false;
+  };
+  auto hasResource = [&g](HexCoord h) {
+    return g.IsInBounds(h) && pack::DecodeResourceID(g.PeekResource(h)) >= 0;
+  };
+
+  double walkData = time(QUERIES, [&](HexCoord c) { sum += isWalkable(c); });
+  double walkBits = time(QUERIES, [&](HexCoord c) {
+    sum += g.IsInBounds(c) && bits.Test(c, tilebits::WALKABLE);
+  });
+  double anyData = time(QUERIES, [&](HexCoord c) {
+    for (HexCoord h : hexmath::Spiral(c, RADIUS)) {
+      if (hasResource(h)) {
+        sum++;
+        return;
+      }
+    }
+  });
+  double anyBits = time(QUERIES, [&](HexCoord c) {
+    sum += bits.AnyInRange(tilebits::HAS_RESOURCE, c, RADIUS);
+  });
+  double countData = time(AREA_QUERIES, [&](HexCoord c) {
+    int count = 0;
+    for (HexCoord h : hexmath::Range(c, AREA)) {
+      count += hasResource(h);
+    }
+    mismatches += count != bits.CountInRange(tilebits::HAS_RESOURCE, c, AREA);
+  });
+  double countBits = time(AREA_QUERIES, [&](HexCoord c) {
+    sum += bits.CountInRange(tilebits::HAS_RESOURCE, c, AREA);
+  });
+  for (const HexCoord &c : centers) {
+    mismatches +=
+        isWalkable(c) != (g.IsInBounds(c) && bits.Test(c, tilebits::WALKABLE));
+  }
+
+  std::cout << "Tile bits, ns per query (tile data / bits):" << std::endl
+            << "  walkable: " << walkData << " / " << walkBits
+            << ", any resource within " << RADIUS << ": " << anyData << " / "
+            << anyBits << std::endl
+            << "  count resources within " << AREA << ": " << countData
+            << " / " << countBits << ", mismatches " << mismatches
+            << std::endl
+            << "  build: " << buildTime.count() / built << " us per chunk, "
+            << built << " chunks, " << bits.GetBytes() / 1024 << " KB"
+            << std::endl;
+  benchSink = sum;
+}
@@ -0,0 +1,154 @@
+#include "bench.h"
+#include "defines.h"
+#include "hex_map.h"
+#include "hex_math.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+using Clock = std::chrono::high_resolution_clock;
+
+// Lookups and erases per size, std::map needs seconds for 10M otherwise.
+constexpr size_t MAX_QUERIES = 1000000;
+// Largest std::map that is timed, 10M take GBs and a minute to fill.
+constexpr size_t MAX_TREE_ENTRIES = 1000000;
+
+// Keeps the timed lookups from being optimized out.
+volatile u64 benchSink;
+
+struct Timings {
+  double insert;
+  double hit;
+  double miss;
+  double erase;
+  size_t bytes; // 0 if unknown
+};
+
+// One interface over the three containers for the timing loop
+struct FlatMap {
+  HexMap<int> map;
+  void Insert(HexCoord h, int v) { map.Insert(h, v); }
+  const int *Find(HexCoord h) const { return map.Find(h); }
+  void Erase(HexCoord h) { map.Erase(h); }
+  size_t GetBytes() const { return map.GetBytes(); }
+};
+
+struct HashMap {
+  std::unordered_map<u64, int> map;
+  void Insert(HexCoord h, int v) { map.emplace(hexmap::Pack(h), v); }
+  const int *Find(HexCoord h) const {
+    auto it = map.find(hexmap::Pack(h));
+    return it != map.end() ? &it->second : nullptr;
+  }
+  void Erase(HexCoord h) { map.erase(hexmap::Pack(h)); }
+  size_t GetBytes() const { return 0; }
+};
+
+struct TreeMap {
+  std::map<HexCoord, int> map;
+  void Insert(HexCoord h, int v) { map.emplace(h, v); }
+  const int *Find(HexCoord h) const {
+    auto it = map.find(h);
+    return it != map.end() ? &it->second : nullptr;
+  }
+  void Erase(HexCoord h) { map.erase(h); }
+  size_t GetBytes() const { return 0; }
+};
+
+double NanosPer(Clock::time_point start, size_t count) {
+  std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+  return elapsed.count() / count;
+}
+
+template <typename Map>
+Timings Measure(const std::vector<HexCoord> &tiles,
+                const std::vector<HexCoord> &hits,
+                const std::vector<HexCoord> &misses) {
+  Timings t;
+  Map *map = new Map;
+  u64 sum = 0;
+
+  auto start = Clock::now();
+  for (size_t i = 0; i < tiles.size(); i++) {
+    map->Insert(tiles[i], (int)i);
+  }
+  t.insert = NanosPer(start, tiles.size());
+  t.bytes = map->GetBytes();
+
+  start = Clock::now();
+  for (HexCoord h : hits) {
+    const int *v = map->Find(h);
+    sum += v != nullptr ? *v : 0;
+  }
+  t.hit = NanosPer(start, hits.size());
+
+  start = Clock::now();
+  for (HexCoord h : misses) {
+    sum += map->Find(h) != nullptr;
+  }
+  t.miss = NanosPer(start, misses.size());
+
+  start = Clock::now();
+  for (HexCoord h : hits) {
+    map->Erase(h);
+  }
+  t.erase = NanosPer(start, hits.size());
+
+  delete map;
+  benchSink = sum;
+  return t;
+}
+
+void Print(const char *name, size_t count, const Timings &t) {
+  std::cout << "  " << name << "insert " << t.insert << ", hit " << t.hit
+            << ", miss " << t.miss << ", erase " << t.erase << " ns";
+  if (t.bytes != 0) {
+    std::cout << ", " << (double)t.bytes / count << " B/entry";
+  }
+  std::cout << std::endl;
+}
+} // namespace
+
+namespace bench {
+
+void HexMaps(size_t maxEntries) {
+  std::mt19937 rng(1);
+  std::cout << "Tile maps, ns per operation:" << std::endl;
+  for (size_t count = 1000; count <= maxEntries; count *= 10) {
+    // A compact patch of the map, like an overlay or a search area,
+    // inserted and queried in random order
+    std::vector<HexCoord> tiles;
+    tiles.reserve(count);
+    for (HexCoord h : hexmath::Spiral(HexCoord(0, 0), 2000)) {
+      if (tiles.size() == count) {
+        break;
+      }
+      tiles.push_back(h);
+    }
+    std::shuffle(tiles.begin(), tiles.end(), rng);
+
+    std::vector<HexCoord> hits(tiles.begin(),
+                               tiles.begin() + std::min(count, MAX_QUERIES));
+    std::shuffle(hits.begin(), hits.end(), rng);
+    std::vector<HexCoord> misses = hits;
+    for (HexCoord &h : misses) {
+      h = h + HexCoord(5000, -5000);
+    }
+
+    std::cout << count << " tiles:" << std::endl;
+    Print("HexMap:        ", count, Measure<FlatMap>(tiles, hits, misses));
+    Print("unordered_map: ", count, Measure<HashMap>(tiles, hits, misses));
+    if (count <= MAX_TREE_ENTRIES) {
+      Print("map:           ", count, Measure<TreeMap>(tiles, hits, misses));
+    } else {
+      std::cout << "  map:           skipped above " << MAX_TREE_ENTRIES
+                << " tiles" << std::endl;
+    }
+  }
+}
+} // namespace bench
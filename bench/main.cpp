@@ -0,0 +1,64 @@
+#include "GFX_manager.h"
+#include "bench.h"
+#include "defines.h"
+#include "hex_tile_grid.h"
+#include "raylib.h"
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <system_error>
+
+// usage: bench [max map entries], 1M by default, up to 10M
+int main(int argc, char **argv) {
+  size_t maxMapEntries = 1000000;
+  if (argc > 1) {
+    maxMapEntries = std::strtoull(argv[1], nullptr, 10);
+  }
+  if (maxMapEntries < 1000 || maxMapEntries > 10000000) {
+    std::cout << "Error: map entries must be 1000 to 10000000" << std::endl;
+    return 1;
+  }
+
+  // The grid writes its journal and chunk cache to the working directory,
+  // keep them away from the game's save.
+  std::error_code ec;
+  std::filesystem::path dir =
+      std::filesystem::temp_directory_path(ec) / "hexvile_bench";
+  std::filesystem::remove_all(dir, ec);
+  std::filesystem::create_directories(dir, ec);
+  std::filesystem::current_path(dir, ec);
+  if (ec) {
+    std::cout << "Error entering " << dir << ": " << ec.message()
+              << std::endl;
+    return 1;
+  }
+
+  // --- World ---
+  // A screen around the origin, with some edited tiles as in a played world
+  Rectangle cameraRect = {-conf::SCREEN_WIDTH / 2.0f,
+                          -conf::SCREEN_HEIGHT / 2.0f,
+                          (float)conf::SCREEN_WIDTH,
+                          (float)conf::SCREEN_HEIGHT};
+  HexGrid grid;
+  grid.InitGrid(conf::MAP_RADIUS);
+  grid.SetCamRectPointer(&cameraRect);
+  for (int i = 0; i < 64; i++) {
+    grid.SetTile(HexCoord(i * 7 % 41 - 20, i * 13 % 37 - 18), tile::DIRT);
+  }
+  grid.InitSpawn(cameraRect);
+  grid.Update(Camera2D{}, 0.0f);
+
+  // --- Benchmarks ---
+  GridBench::TileOrder(grid);
+  GridBench::CoordConversion(grid);
+  bool heapFree = GridBench::HexIterators(grid);
+  GridBench::TileBits(grid);
+  bench::HexMaps(maxMapEntries);
+  GFX_Manager gfx;
+  GFXBench::LayerSort(gfx);
+
+  grid.Shutdown();
+  std::filesystem::current_path(dir.parent_path(), ec);
+  std::filesystem::remove_all(dir, ec);
+  return heapFree ? 0 : 1;
+}
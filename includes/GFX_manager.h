@@ -3,42 +3,104 @@
 
 #include "raylib.h"
 
+#include "defines.h"
 #include "enums.h"
 #include "texture.h"
+#include <utility>
 #include <vector>
 
 namespace gfx {
 
-struct Object {
+// How the objects of a layer are ordered for drawing.
+enum SortPolicy {
+  UNSORTED,  // Submission order, the producers draw what belongs on top last
+  PRESORTED, // Producers submit in sortY order
+  SORT_BY_Y, // Sorted by sortY, stable
+};
+
+// Per drawMask::id. Tiles are generated row by row, so they arrive in y
+// order. The player is submitted after the tile details, that layer needs a
+// real sort.
+constexpr SortPolicy LAYER_SORT[drawMask::SIZE] = {
+    UNSORTED,  // NULL_ID
+    PRESORTED, // GROUND0
+    UNSORTED,  // GROUND1
+    SORT_BY_Y, // SHADOW
+    SORT_BY_Y, // ON_GROUND
+    UNSORTED,  // UI_0
+    UNSORTED,  // UI_1
+    UNSORTED,  // UI_2
+    UNSORTED,  // DEBUG_OVERLAY
+};
+
+// Fixed-point steps of Command::scale and the origin. 240 is exact for the
+// values tex::Opts uses: scales 0.4, 1, 1.9, 2.4 (2 * UI_SCALE) and 6,
+// origins 0, 0.475, 0.5 and 1. The fields hold scales up to 273 and
+// origins up to 1.0625, larger and negative ones are clamped.
+constexpr int SCALE_ONE = 240;
+constexpr int ORIGIN_ONE = 240;
+
+// Command::flags
+constexpr u8 HIT_SHADER = 1 << 0;
+
+// A rect of a registered texture.
+struct Sprite {
+  u16 id;     // Index into the rect table
+  u8 texture; // Index into the texture table, the atlas is 0
+};
+
+/* One queued draw, 24 bytes. Source is rect 'sprite' of texture 'texture',
+ * the drawn size is the rect size times scale / SCALE_ONE. (x, y) is where
+ * the origin lands, the origin is a fraction of the drawn size.
+ */
+struct Command {
   float sortY;
-  Texture2D texture;
-  Rectangle srcRec;
-  Rectangle dstRec;
-  Vector2 origin;
+  float x;
+  float y;
+  u16 sprite;
+  u16 scale;
+  u8 texture;
+  u8 flags;
+  u8 originX; // Of ORIGIN_ONE
+  u8 originY;
   Color color;
-  bool useHitShader;
 };
+static_assert(sizeof(Command) == 24, "gfx::Command grew");
 
 } // namespace gfx
 
 class GFX_Manager {
+  // Times SortLayer(), see bench/
+  friend class GFXBench;
+
 private:
   // --- Members ---
   int TA_Width;
   int TA_Height;
   Texture2D textureAtlas;
   Shader hitShader;
-  std::vector<std::vector<Rectangle>> textureRecData;
+  // Texture table, filled while loading. Atlas cell (x, y) is rect
+  // y * TA_Width + x, the larger atlas sprites and registered textures
+  // follow.
+  std::vector<Texture2D> textures;
+  std::vector<Rectangle> spriteRecs;
+  std::vector<std::pair<tex::atlas::Coords, u16>> largeSprites;
 
   // 0: Front (Render), 1: Back (Logic)
-  std::vector<std::vector<std::vector<gfx::Object>>>
-      GFX_Data_Buffers; // [BufferIndex][LayerID][Object]
+  std::vector<std::vector<std::vector<gfx::Command>>>
+      GFX_Data_Buffers; // [BufferIndex][LayerID][Command]
   //
   int backBufferIndex = 1;
 
+  // Radix sort scratch, logic thread
+  std::vector<u64> sortItems; // Quantized sortY << 32 | command index
+  std::vector<u64> sortItemsScratch;
+  std::vector<gfx::Command> sortedCommands;
+
   // --- Private Methods ---
   void InitTextureRec();
-  Rectangle GetSrcRec(int x, int y);
+  gfx::Sprite GetLargeSprite(tex::atlas::Coords coords) const;
+  void SortLayer(std::vector<gfx::Command> &layer);
 
 public:
   // --- Constructors ---
@@ -47,18 +109,39 @@ public:
   // --- Core Lifecycle ---
   int LoadAssets(const char *);
   void UnloadAssets();
+  // Adds 'texture' to the texture table and 'recs' to the rect table, rect
+  // i is the returned sprite's id + i. Call before the logic thread starts,
+  // the tables are read while rendering.
+  gfx::Sprite AddTexture(Texture2D texture, const Rectangle *recs,
+                         int count);
 
   // --- Graphics / Backbuffer ---
   void LoadTextureToBackbuffer(drawMask::id layerID, tex::atlas::Coords texAtlas,
                                Vector2 dst, tex::Opts opts = {});
-  void LoadTextureToBackbuffer_Raw(drawMask::id layerID, Texture2D texture,
-                                   Rectangle srcRec, Rectangle dstRec,
-                                   tex::Opts opts = {});
+  // Fast path: 'sprite' unscaled with its top left corner at 'dst'.
+  void LoadSpriteToBackbuffer(drawMask::id layerID, gfx::Sprite sprite,
+                              Vector2 dst, Color color = WHITE) {
+    GFX_Data_Buffers[backBufferIndex][layerID].push_back(
+        {dst.y, dst.x, dst.y, sprite.id, gfx::SCALE_ONE, sprite.texture, 0, 0,
+         0, color});
+  }
+  // Orders every layer of the back buffer by its gfx::LAYER_SORT. Call on
+  // the logic thread once the frame is submitted, RenderLayer() only
+  // iterates.
+  void SortBackBuffer();
   void RenderLayer(drawMask::id layer);
   void SwapBuffers();
 
   // --- Getters ---
   Rectangle GetTileRec(tile::id id, int frame);
+  // Atlas cell sprites are a multiply, larger ones a search of the few
+  // registered in LoadAssets().
+  gfx::Sprite GetAtlasSprite(tex::atlas::Coords coords) const {
+    if (coords.width == 1 && coords.height == 1) {
+      return {(u16)(coords.y * TA_Width + coords.x), 0};
+    }
+    return GetLargeSprite(coords);
+  }
 };
 
 #endif // !GRAPHICS_MANAGER_H
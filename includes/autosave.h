@@ -0,0 +1,86 @@
+#ifndef AUTOSAVE_H
+#define AUTOSAVE_H
+
+#include "chunk_codec.h"
+#include "chunk_store.h"
+#include "defines.h"
+#include "save_format.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/* --- Autosave ---
+ * Appends changed chunks to a journal on a background thread. The logic
+ * thread only takes the dirty slots and pins the committed snapshot, which
+ * is O(dirty). The writer encodes the pinned chunks, they are immutable.
+ *
+ * Journal layout: SaveHeader (JOURNAL_MAGIC), SaveWorldHeader, then chunk
+ * blocks up to the end of the file. Later blocks override earlier ones, a
+ * full save truncates the journal.
+ */
+constexpr char JOURNAL_MAGIC[4] = {'H', 'X', 'V', 'J'};
+
+class Autosave {
+private:
+  // --- Dependencies ---
+  ChunkStore *chunks;
+
+  // --- Members ---
+  std::string path;
+  SaveWorldHeader worldHeader;
+  int readerID; // Snapshot reader slot of the writer
+  float timer;
+  std::vector<int> takenSlots;
+
+  // Writer thread and its single job
+  std::thread worker;
+  std::mutex jobMutex;
+  std::condition_variable jobCV;
+  bool isRunning;
+  bool isBusy;
+  const WorldSnapshot *jobSnapshot;
+  std::vector<int> jobSlots;
+  codec::Buffers buffers;
+
+  // Profiling
+  std::atomic<double> snapshotTime; // Logic thread, us
+  std::atomic<double> writeTime;    // Writer thread, ms
+  std::atomic<size_t> bytesWritten; // Last batch
+
+  // --- Private Methods ---
+  void WorkerLoop();
+  void WriteJob();
+  bool WriteHeader();
+  void WaitIdle();
+
+public:
+  // --- Constructors ---
+  Autosave();
+  ~Autosave();
+  Autosave(const Autosave &) = delete;
+  Autosave &operator=(const Autosave &) = delete;
+
+  // --- Core Lifecycle ---
+  void Start(ChunkStore *chunks, const char *path,
+             const SaveWorldHeader &header);
+  // Writes what is still dirty, then joins the writer.
+  void Stop();
+  // Call after ChunkStore::Commit(), saves every AUTOSAVE_PERIOD seconds.
+  void Update(float deltaTime);
+  // Hands the dirty chunks to the writer. False if it is still busy.
+  bool Trigger();
+  // Forgets pending changes and truncates the journal, after a full save.
+  void Reset();
+  // Applies the journal to the store. Resets it if it is unreadable.
+  int Replay();
+
+  // --- Getters ---
+  double GetSnapshotTime() const;
+  double GetWriteTime() const;
+  size_t GetBytesWritten() const;
+};
+
+#endif // !AUTOSAVE_H
@@ -0,0 +1,60 @@
+#ifndef CHUNK_CACHE_H
+#define CHUNK_CACHE_H
+
+#include "defines.h"
+#include "save_format.h"
+#include <fstream>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+/* --- Chunk Cache ---
+ * Scratch file for chunks evicted from memory. Blocks have the save file
+ * layout, SaveChunkHeader plus the compressed chunk, so a full save copies
+ * them unchanged.
+ *
+ * Every slot owns one extent. It is reused when the chunk is evicted again
+ * and still fits, otherwise a new one is appended. The cache only lives
+ * for one session, Open() and Reset() truncate it. The extent table grows
+ * with the slots of an unbounded world.
+ */
+class ChunkCache {
+private:
+  struct Extent {
+    u64 offset;
+    u32 capacity; // 0: nothing cached
+  };
+
+  // --- Members ---
+  std::string path;
+  std::fstream stream;
+  std::vector<Extent> extents;
+  u64 fileEnd;
+  u64 writePos; // Put position, appends skip the seek and stay buffered
+
+public:
+  // --- Constructors ---
+  ChunkCache();
+  ChunkCache(const ChunkCache &) = delete;
+  ChunkCache &operator=(const ChunkCache &) = delete;
+
+  // --- Core Lifecycle ---
+  bool Open(const char *path, int slots);
+  void Close();
+  void Flush();
+  // Forgets every block.
+  void Reset();
+
+  // --- Blocks ---
+  bool Write(int slot, const SaveChunkHeader &header,
+             const std::vector<u8> &packed);
+  bool Read(int slot, SaveChunkHeader &header, std::vector<u8> &packed);
+  // Appends the block of 'slot' to 'out' as is. Returns the bytes copied.
+  size_t CopyBlock(int slot, std::ostream &out) const;
+
+  // --- Getters ---
+  bool IsOpen() const;
+  u64 GetFileSize() const;
+};
+
+#endif // !CHUNK_CACHE_H
@@ -0,0 +1,56 @@
+#ifndef CHUNK_CODEC_H
+#define CHUNK_CODEC_H
+
+#include "chunk_store.h"
+#include "defines.h"
+#include "save_format.h"
+#include <cstddef>
+#include <iosfwd>
+#include <vector>
+
+/* --- Chunk Codec ---
+ * Serialised form of one chunk, independent of the dense/sparse layout.
+ * Only tiles that deviate from the base world are written, split into byte
+ * planes so runs line up for the run-length coder:
+ *
+ *   u16 count
+ *   u8  indexDelta[count] low bytes, then high bytes
+ *   u8  id[count]
+ *   u8  rsrc[count]       low bytes, then high bytes
+ */
+namespace codec {
+// Returns the number of edits written to 'out'. 0 means the chunk is
+// pristine and does not need to be saved.
+int EncodeChunk(const chunk::Chunk &c, std::vector<u8> &out);
+bool DecodeChunk(const u8 *data, size_t size, chunk::Chunk &c);
+
+/* Byte-wise run-length coding, each block starts with a control byte:
+ *   0..127    copy the next (control + 1) bytes
+ *   128..255  repeat the next byte (control - 128 + MIN_RUN) times
+ */
+void Compress(const u8 *data, size_t size, std::vector<u8> &out);
+bool Decompress(const u8 *data, size_t size, size_t rawSize,
+                std::vector<u8> &out);
+
+// --- Blocks ---
+// SaveChunkHeader plus the compressed chunk. An empty block (rawSize 0)
+// reverts the chunk to the base world.
+struct Buffers {
+  std::vector<u8> raw;
+  std::vector<u8> packed;
+};
+
+// Returns the bytes written. Pristine chunks are written as empty blocks,
+// or skipped (0 bytes) with 'skipPristine'.
+size_t WriteBlock(std::ostream &out, int cq, int cr, const chunk::Chunk *c,
+                  bool skipPristine, Buffers &buf);
+// Reads a block without decoding it, 'packed' receives the compressed
+// chunk. Only the sizes are checked.
+bool ReadPackedBlock(std::istream &in, SaveChunkHeader &header,
+                     std::vector<u8> &packed);
+// 'c' receives a new chunk, or nullptr for an empty block.
+bool ReadBlock(std::istream &in, Buffers &buf, int &cq, int &cr,
+               chunk::Chunk *&c);
+} // namespace codec
+
+#endif // !CHUNK_CODEC_H
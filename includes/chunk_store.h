@@ -0,0 +1,370 @@
+#ifndef CHUNK_STORE_H
+#define CHUNK_STORE_H
+
+#include "chunk_cache.h"
+#include "defines.h"
+#include "hex_map.h"
+#include "map_tile.h"
+#include "save_format.h"
+#include "world_file.h"
+#include <atomic>
+#include <cstddef>
+#include <iosfwd>
+#include <type_traits>
+#include <vector>
+
+/* Tiles are grouped into square chunks in axial (q, r) space, which are
+ * parallelograms on screen:
+ *
+ *   chunk (cq, cr) holds q in [cq * SIZE, cq * SIZE + SIZE)
+ *                        r in [cr * SIZE, cr * SIZE + SIZE)
+ *
+ * Coordinates are shifted by the map radius first, so every in-bounds tile
+ * maps to a non-negative chunk index.
+ *
+ * The directory of a bounded world is trimmed to the hexagon: each chunk row
+ * only holds the columns that overlap the map, the corners of the bounding
+ * square get no slot at all.
+ *
+ * Unbounded worlds (map radius 0) use the coordinates as they are, chunk
+ * indices may be negative. Chunks are grouped into regions of
+ * REGION_SIZE x REGION_SIZE, which get their slots when one of their chunks
+ * is first used. Regions are found through a hash map keyed by the 64-bit
+ * region coordinates, so the directory grows with the explored area.
+ */
+namespace chunk {
+constexpr int SHIFT = conf::CHUNK_SHIFT;
+constexpr int SIZE = 1 << SHIFT;
+constexpr int MASK = SIZE - 1;
+constexpr int TILES = SIZE * SIZE;
+constexpr int MAX_READERS = 4;
+constexpr int REGION_SHIFT = conf::REGION_SHIFT;
+constexpr int REGION_SIZE = 1 << REGION_SHIFT;
+constexpr int REGION_MASK = REGION_SIZE - 1;
+constexpr int REGION_SLOTS = REGION_SIZE * REGION_SIZE;
+constexpr int NO_SLOT = -1;
+
+// Order of the tiles in a chunk's arrays. Row-major keeps a tile row
+// contiguous, its r +- 1 neighbors are SIZE entries away. Morton interleaves
+// the bits of lq and lr, any 2^k x 2^k block is contiguous.
+constexpr u16 ROW_MAJOR = 0;
+constexpr u16 MORTON = 1;
+constexpr u16 TILE_ORDER = conf::MORTON_TILE_ORDER ? MORTON : ROW_MAJOR;
+
+// Tile id of a tile that was never written, the base world decides.
+// Unwritten resources read as pack::RESOURCE_PRISTINE.
+constexpr u8 BASE_ID = 0xff;
+
+// Every tile of the chunk is stored. Properties are split into parallel
+// arrays so hot queries (walkability, culling) only pull the 1 byte tile ids
+// through the cache. Resources are bit-packed, see pack::Resource. Details
+// are derived, not stored.
+struct DenseChunk {
+  u8 ids[TILES]; // tile::id or BASE_ID
+  pack::Resource rsrc[TILES];
+  u32 generation; // Store generation the chunk was created or copied in
+
+  DenseChunk();
+  u8 GetID(int i) const;
+  pack::Resource GetResource(int i) const;
+  void SetID(int i, u8 id);
+  void SetResource(int i, pack::Resource rsrc);
+  size_t GetBytes() const;
+};
+static_assert(sizeof(u8) + sizeof(pack::Resource) <= 8,
+              "Tile storage exceeds 8 bytes");
+
+// One tile that deviates from the base world.
+struct TileEdit {
+  u16 index; // ChunkStore::LocalIndex
+  u8 id;
+  pack::Resource rsrc;
+};
+static_assert(TILES <= 1 << 16, "Local index does not fit TileEdit");
+
+// Only written tiles are stored, sorted by local index. Memory grows with
+// the number of edits, not with the area touched.
+struct SparseChunk {
+  std::vector<TileEdit> edits;
+  u32 generation; // Store generation the chunk was created or copied in
+
+  SparseChunk();
+  u8 GetID(int i) const;
+  pack::Resource GetResource(int i) const;
+  void SetID(int i, u8 id);
+  void SetResource(int i, pack::Resource rsrc);
+  size_t GetBytes() const;
+
+private:
+  TileEdit &Acquire(int i);
+};
+
+using Chunk = std::conditional_t<conf::SPARSE_TILE_STORAGE &&
+                                      !conf::MAPPED_TILE_STORAGE,
+                                  SparseChunk, DenseChunk>;
+
+// Where the chunk of a slot lives when it is not in the live directory.
+constexpr u8 RESIDENT = 0; // Live, or never touched
+constexpr u8 PACKED = 1;   // Compressed in memory
+constexpr u8 EVICTED = 2;  // In the chunk cache on disk
+
+// Codec block of a cold chunk, see chunk_codec.h.
+struct PackedChunk {
+  SaveChunkHeader header;
+  std::vector<u8> data;
+};
+
+// Region directory of an unbounded world. Never changed once published,
+// adding a region replaces it with a copy.
+struct Regions {
+  HexMap<int> firstSlot;        // Region coordinates -> first slot
+  std::vector<HexCoord> coords; // Region coordinates per REGION_SLOTS
+};
+
+// Local tile coordinates (0..MASK) to the index into the tile arrays of a
+// chunk, in TILE_ORDER, and back.
+int TileIndex(int lq, int lr);
+void TileCoords(int i, int &lq, int &lr);
+
+// Spreads the low 8 bits of 'v' to the even bits.
+constexpr int SpreadBits(int v) {
+  v = (v | (v << 4)) & 0x0f0f;
+  v = (v | (v << 2)) & 0x3333;
+  return (v | (v << 1)) & 0x5555;
+}
+
+constexpr int MortonIndex(int lq, int lr) {
+  return SpreadBits(lq) | SpreadBits(lr) << 1;
+}
+
+// Maps chunks to directory slots. Bounded worlds use the per-row offset
+// table of the trimmed directory:
+//   slot = rowOffset[cr] + cq - rowFirst[cr]
+// Unbounded worlds look up the first slot of the region:
+//   slot = firstSlot[region] + (cr & REGION_MASK) * REGION_SIZE
+//                            + (cq & REGION_MASK)
+struct Layout {
+  int mapRadius = 0; // 0: unbounded
+  int slots = 0;
+  std::vector<int> rowOffset;
+  std::vector<int> rowFirst;
+  const Regions *regions = nullptr; // Unbounded only, owned by the store
+
+  void Init(int mapRadius);
+  bool IsUnbounded() const;
+  // (q, r) must be in bounds. NO_SLOT if its region has no slots yet.
+  int Index(int q, int r) const;
+  // NO_SLOT if (cq, cr) has no slot (yet).
+  int Slot(int cq, int cr) const;
+  // Chunk coordinates of 'slot'.
+  void Coords(int slot, int &cq, int &cr) const;
+};
+} // namespace chunk
+
+// --- World Snapshot ---
+// Immutable view of the chunk directory. Chunks reachable from a snapshot
+// are never written, writers copy them first.
+struct WorldSnapshot {
+  std::vector<const chunk::Chunk *> chunks;
+  u32 generation;
+  chunk::Layout layout; // Directory of this generation
+
+  const chunk::Chunk *Find(int q, int r) const;
+};
+
+/* --- Chunk Store ---
+ * Directory of lazily allocated chunks with copy-on-write snapshots.
+ *
+ * The logic thread owns the live directory. The first write to a chunk that
+ * is part of the published snapshot copies it, later writes in the same
+ * generation go to that copy. Commit() publishes the live directory as the
+ * next snapshot.
+ *
+ * Background readers pin a snapshot with AcquireSnapshot(), which only
+ * stores their epoch. Replaced chunks and snapshots are freed once every
+ * reader has moved past the epoch they were retired in.
+ *
+ * With a mapped world file, chunks saved in the file are used in place and
+ * paged in by the OS on first read. They are treated as shared, the first
+ * write copies them to the heap. Flush() writes heap chunks back.
+ *
+ * Without one, chunks that were not touched for a while are packed into
+ * their compressed codec block in memory, and evicted to a chunk cache on
+ * disk to stay within a memory budget. Logic thread accesses unpack or
+ * reload them transparently. Snapshots read cold chunks as the base world,
+ * readers must only look at touched chunks. Chunks with changes pending
+ * for the journal are never packed or evicted.
+ */
+class ChunkStore {
+private:
+  struct Retired {
+    u64 epoch;
+    const chunk::Chunk *chunk;
+    const WorldSnapshot *snapshot;
+    const chunk::Regions *regions;
+  };
+
+  // --- Members ---
+  chunk::Layout layout;
+  WorldFile file;
+  ChunkCache cache;
+  std::vector<chunk::Chunk *> live;
+  std::vector<const chunk::Chunk *> replaced;
+  chunk::Regions *regions; // layout.regions, writable
+  bool isRegionsShared;    // Published by the last Commit()
+  std::vector<const chunk::Regions *> replacedRegions;
+  std::vector<Retired> retired;
+  std::vector<u8> isSlotDirty;
+  std::vector<int> dirtySlots; // Slots changed since the last TakeDirtySlots
+  std::vector<u8> residency; // chunk::RESIDENT, PACKED or EVICTED
+  std::vector<chunk::PackedChunk *> packed;
+  std::vector<u32> lastTouched; // Eviction round the slot was last used in
+  u32 touchClock;
+  std::vector<u8> cacheRaw;
+  std::vector<u8> cachePacked;
+  std::atomic<const WorldSnapshot *> published;
+  std::atomic<u64> epoch;
+  std::atomic<u64> readerEpochs[chunk::MAX_READERS];
+  int readerCount;
+  u32 generation;
+  bool isDirty;
+  int mapRadius;
+  int chunksLoaded;
+  int chunksEvicted;
+  int chunksPacked;
+  size_t packedBytes;
+
+  // Profiling
+  int evictCount;
+  int reloadCount;
+  double evictTime;  // Last eviction round, us per chunk
+  double reloadTime; // Last reload, us
+  double packRate;   // Last packing round, MB/s of unpacked blocks
+  double unpackRate; // Last unpack, MB/s of unpacked blocks
+
+  // --- Private Methods ---
+  void Reclaim();
+  void FreeChunk(const chunk::Chunk *c);
+  void GrowSlots();
+  void PublishSlot(int slot, chunk::Chunk *c);
+  void DropSlot(int slot);
+  void MarkDirty(int slot);
+  bool EncodeBlock(int slot, const chunk::Chunk &c, SaveChunkHeader &header);
+  chunk::Chunk *DecodeBlock(const SaveChunkHeader &header,
+                            const std::vector<u8> &data,
+                            std::vector<u8> &raw) const;
+  void Install(int slot, chunk::Chunk *c);
+  void Release(int slot);
+  size_t Pack(int slot);
+  bool Unpack(int slot);
+  bool Evict(int slot);
+  bool Reload(int slot);
+  bool Restore(int slot);
+  bool DropCold(int slot);
+  void FreePacked(int slot);
+
+public:
+  // --- Constructors ---
+  ChunkStore();
+  ~ChunkStore();
+  ChunkStore(const ChunkStore &) = delete;
+  ChunkStore &operator=(const ChunkStore &) = delete;
+
+  // --- Core Lifecycle ---
+  // A map radius of 0 makes the world unbounded.
+  void Init(int mapRadius);
+  void Clear();
+  void Commit();
+
+  // --- World File ---
+  // Call right after Init(), before any chunk is stored. Bounded worlds
+  // only, the file has a fixed slot count.
+  bool MapFile(const char *path, u64 seed);
+  // Writes every heap chunk to the file. Readers must be idle.
+  void Flush();
+
+  // --- Save / Load (logic thread) ---
+  // Chunk section of the save file, see save_format.h.
+  bool Save(std::ostream &out) const;
+  // Reads the chunk section into 'blocks' and checks that every block
+  // decodes and has a slot. The store is left alone, a damaged save
+  // cannot touch the live world.
+  bool ReadSave(std::istream &in,
+                std::vector<chunk::PackedChunk> &blocks) const;
+  // Replaces every chunk with the blocks of a successful ReadSave(). Loaded
+  // chunks stay packed until they are used.
+  void ApplySave(std::vector<chunk::PackedChunk> &blocks);
+  // Applies chunk blocks written by Autosave, returns the count.
+  int ReplayJournal(std::istream &in);
+  // Drops every chunk, the world reads as the base world again.
+  void Discard();
+
+  // --- Chunk Cache (logic thread) ---
+  // Call right after Init(), not together with a world file.
+  bool OpenCache(const char *path);
+  // Marks the chunk in 'slot' as in use, it is kept in memory this round.
+  // Unpacks or reloads it if it was cold. A cold copy that does not decode
+  // is kept, the slot reads as the base world until it does.
+  void Touch(int slot);
+  // Touch() for many slots, packed ones are decoded on every core.
+  void Prefetch(const std::vector<int> &slots);
+  // Packs chunks that were not touched for 'minAge' rounds, at most
+  // CHUNK_PACK_MAX per call. Packed slots are appended to 'out'.
+  void PackCold(u32 minAge, std::vector<int> &out);
+  // Evicts the least recently touched chunks until the heap use is below
+  // 'targetBytes', once it exceeds 'budgetBytes'. Starts a new round.
+  // Evicted slots are appended to 'out'.
+  void EvictToBudget(size_t budgetBytes, size_t targetBytes,
+                     std::vector<int> &out);
+
+  // --- Dirty Tracking (logic thread) ---
+  // Moves the slots changed since the last call into 'out', O(dirty).
+  void TakeDirtySlots(std::vector<int> &out);
+  int GetDirtyCount() const;
+
+  // --- Chunk Access (logic thread) ---
+  // (q, r) must be in bounds.
+  // Returns nullptr if the chunk holding (q, r) was never touched.
+  const chunk::Chunk *Find(int q, int r) const;
+  // Writable chunk holding (q, r), copied if a snapshot still shares it.
+  // Returns nullptr if the chunk was never touched, or if its cold copy
+  // could not be restored.
+  chunk::Chunk *Edit(int q, int r);
+  // Stores a fully initialised chunk for (q, r). Takes ownership. Returns
+  // false and deletes 'c' if the slot holds a cold copy that could not be
+  // restored, the copy is kept.
+  bool Publish(int q, int r, chunk::Chunk *c);
+  // Slot of chunk (cq, cr). Unbounded worlds hand out the slots of its
+  // region first if it has none. NO_SLOT outside a bounded world.
+  int AcquireSlot(int cq, int cr);
+
+  // --- Snapshots (any thread) ---
+  int RegisterReader();
+  const WorldSnapshot *AcquireSnapshot(int readerID);
+  void ReleaseSnapshot(int readerID);
+
+  // --- Getters ---
+  int GetChunksLoaded() const;
+  int GetChunkSlots() const;
+  u32 GetGeneration() const;
+  size_t GetBytesInUse() const;
+  int GetChunksEvicted() const;
+  int GetChunksPacked() const;
+  size_t GetPackedBytes() const;
+  double GetPackRate() const;
+  double GetUnpackRate() const;
+  int GetEvictCount() const;
+  int GetReloadCount() const;
+  double GetEvictTime() const;
+  double GetReloadTime() const;
+
+  // --- Conversions / Helpers ---
+  int LocalIndex(int q, int r) const;
+  // Directory slot of the chunk holding (q, r), which must be in bounds.
+  // NO_SLOT if the chunk has none yet.
+  int SlotIndex(int q, int r) const;
+  int ChunkCoord(int coord) const;
+  int ChunkOrigin(int chunkCoord) const;
+};
+
+#endif // !CHUNK_STORE_H
@@ -0,0 +1,117 @@
+#ifndef CHUNK_STREAMER_H
+#define CHUNK_STREAMER_H
+
+#include "chunk_store.h"
+#include "defines.h"
+#include "map_tile.h"
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// --- Baked Chunk ---
+// Rolled details and untouched resources of one chunk. Rendering reads them
+// instead of hashing every visible tile every frame.
+struct BakedChunk {
+  int slot;
+  int cq;
+  int cr;
+  u32 version; // Slot version the bake was requested for
+  TileDet det[chunk::TILES][conf::TERRAIN_DETAILS_MAX];
+  pack::Resource rsrc[chunk::TILES]; // Rolled, stored bits take precedence
+  BakedChunk *next;                  // Handoff list
+};
+
+struct StreamRequest {
+  int slot;
+  int cq;
+  int cr;
+  u32 version;
+
+  bool operator==(const StreamRequest &other) const;
+};
+
+/* --- Chunk Streamer ---
+ * Bakes chunks ahead of the camera on a worker thread.
+ *
+ * The logic thread owns the table of baked chunks. Each Update() it hands
+ * the chunks it wants, in priority order, to the worker through a
+ * single-slot mailbox; a newer list replaces one that was not worked off
+ * yet. Finished chunks come back through a lock-free list and are
+ * installed on the next Update(), nothing is baked on the logic thread.
+ *
+ * Tile ids decide the rolls. Changing one bumps the slot version, bakes of
+ * an older version are dropped on arrival.
+ */
+class ChunkStreamer {
+public:
+  // Fills the tiles of 'b' from 'snap'. Runs on the worker thread.
+  using BakeFunc = std::function<void(const WorldSnapshot *, BakedChunk &)>;
+
+private:
+  // --- Dependencies ---
+  ChunkStore *chunks;
+  BakeFunc bake;
+
+  // --- Members (logic thread) ---
+  std::vector<BakedChunk *> baked;
+  std::vector<u32> versions;
+  std::vector<u32> lastWanted; // Update() count the slot was last wanted
+  std::vector<int> residentSlots;
+  std::vector<StreamRequest> missing;
+  std::vector<StreamRequest> lastPosted;
+  u32 updateCount;
+
+  // Worker thread and its mailbox
+  std::thread worker;
+  std::mutex requestMutex;
+  std::condition_variable requestCV;
+  bool isRunning;
+  bool isBusy;
+  std::vector<StreamRequest> requests;
+  std::atomic<BakedChunk *> finished;
+  int readerID; // Snapshot reader slot of the worker
+
+  // Profiling
+  std::atomic<double> bakeTime; // Last chunk, us
+
+  // --- Private Methods ---
+  void WorkerLoop();
+  void Install(BakedChunk *b);
+  void Evict();
+  void Drop(int slot);
+  void DrainFinished();
+  void GrowTables();
+  void WaitIdle();
+
+public:
+  // --- Constructors ---
+  ChunkStreamer();
+  ~ChunkStreamer();
+  ChunkStreamer(const ChunkStreamer &) = delete;
+  ChunkStreamer &operator=(const ChunkStreamer &) = delete;
+
+  // --- Core Lifecycle ---
+  void Start(ChunkStore *chunks, BakeFunc bake);
+  void Stop();
+  // Installs finished chunks and requests the missing ones of 'wanted',
+  // most important first. Call after ChunkStore::Commit().
+  void Update(const std::vector<StreamRequest> &wanted);
+  // Bakes the missing chunks of 'wanted' on every core and installs them
+  // before returning. For the spawn area, the game waits for it anyway.
+  void BakeNow(const std::vector<StreamRequest> &wanted);
+  // The tile ids of 'slot' changed, its bake is stale.
+  void Invalidate(int slot);
+  // The whole world was replaced. Waits for the worker.
+  void Clear();
+
+  // --- Getters ---
+  // Returns nullptr if 'slot' is not baked yet, or NO_SLOT.
+  const BakedChunk *Find(int slot) const;
+  int GetChunksBaked() const;
+  double GetBakeTime() const;
+};
+
+#endif // !CHUNK_STREAMER_H
@@ -20,6 +20,7 @@ private:
   double displayRenderTime;
   double displayLogicTime;
   double displayVisTime;
+  double displayVisLatency;
   double displayRamUsage;
 
   // --- Private Helpers ---
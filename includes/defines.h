@@ -2,6 +2,7 @@
 #define DEFINES_H
 #include "enums.h"
 #include "raylib.h"
+#include <cstddef>
 #include <cstdint>
 #include <vector>
 
@@ -15,6 +16,11 @@ namespace conf {
 //               Core
 // ==========================================
 constexpr int MAP_RADIUS = 1800;
+// Grow the world as it is explored instead of stopping at MAP_RADIUS
+constexpr bool UNBOUNDED_WORLD = false;
+// Re-anchor world coordinates on the player's tile past this distance from
+// the screen center, keeps float positions small on long walks.
+constexpr float ORIGIN_REBASE_DISTANCE = 4096.0f; // World units
 constexpr int MAX_FPS = 8000;
 constexpr const char *WINDOW_TITLE = "HexVile";
 constexpr const char *TEXTURE_ATLAS_PATH = "assets/images/texture_atlas.png";
@@ -27,6 +33,12 @@ constexpr const int RENDER_VIEW_CULLING_EXPANSION =
     conf::RENDER_VIEW_CULLING_MARGIN * 2;
 
 constexpr const int ESTIMATED_VISIBLE_TILES = 3000;
+// Steps per world unit of the sort key of y-sorted draw layers. Objects
+// closer than a step keep their submission order.
+constexpr float GFX_SORT_KEY_STEPS = 4.0f;
+// Diff each new visible window against the previous one. When disabled every
+// recalculation reports the whole window as entered.
+constexpr bool VISIBILITY_DELTA_ENABLED = true;
 
 // ==========================================
 //               Screen
@@ -59,7 +71,56 @@ constexpr int TILE_RESOLUTION_HALF = TILE_RESOLUTION / 2;
 constexpr float TILE_SPACING_X = 18.30f;
 constexpr float TILE_SPACING_Y = 15.95f;
 constexpr float SPAWN_RSRC_SPREAD = 3.0f;
-const std::vector<tile::id> WALKABLE_TILE_IDS = {tile::GRASS, tile::DIRT};
+constexpr tile::id WALKABLE_TILE_IDS[] = {tile::GRASS, tile::DIRT};
+
+// ==========================================
+//               World Storage
+// ==========================================
+constexpr int CHUNK_SHIFT = 5; // Chunk edge = 32 tiles (q and r)
+constexpr int REGION_SHIFT = 3; // Region edge = 8 chunks, unbounded worlds
+// Order the tiles of a chunk along a Morton (Z-order) curve instead of row
+// by row, so a tile and its hex neighbors share cache lines.
+constexpr bool MORTON_TILE_ORDER = false;
+// Store only the tiles that differ from the generated base world instead of
+// every tile of a touched chunk.
+constexpr bool SPARSE_TILE_STORAGE = true;
+// Back chunks with a memory-mapped world file. Implies dense chunks, the
+// file holds their raw layout.
+constexpr bool MAPPED_TILE_STORAGE = false;
+constexpr const char *WORLD_FILE_PATH = "world.hxw";
+constexpr const char *SAVE_FILE_PATH = "world.hxs";
+// Saves are written here first, then renamed over SAVE_FILE_PATH
+constexpr const char *SAVE_TMP_FILE_PATH = "world.hxs.tmp";
+constexpr const char *JOURNAL_FILE_PATH = "world.hxj";
+constexpr float AUTOSAVE_PERIOD = 10.0f; // Seconds between journal writes
+// Details and untouched resources are a pure function of this seed and the
+// tile, equal seeds give equal worlds.
+constexpr std::uint64_t WORLD_SEED = 0x48657856696c65;
+
+// Bake the rolls of chunks ahead of the camera on a worker thread. Tiles of
+// chunks that are not baked yet are rolled in place.
+constexpr bool CHUNK_STREAMING_ENABLED = true;
+constexpr float STREAM_LOOKAHEAD = 2.0f; // Seconds of movement prefetched
+constexpr int STREAM_MAX_CHUNKS = 64;    // Baked chunks kept, ~27 KB each
+
+// Heap budget of tile storage. Above it the chunks that were out of view
+// the longest are evicted to the chunk cache until TILE_MEMORY_TARGET is
+// reached. Not used with MAPPED_TILE_STORAGE, the OS pages the file.
+constexpr const char *CHUNK_CACHE_PATH = "world.hxc";
+constexpr size_t TILE_MEMORY_BUDGET = 32 * 1024 * 1024;
+constexpr size_t TILE_MEMORY_TARGET = TILE_MEMORY_BUDGET / 4 * 3;
+constexpr float CHUNK_EVICT_PERIOD = 1.0f; // Seconds between budget checks
+constexpr int CHUNK_EVICT_MAX = 256;       // Chunks evicted per check
+
+// Chunks out of view for CHUNK_COLD_AGE budget checks are kept packed in
+// memory, in the save block format, and unpacked on their next use.
+constexpr bool COLD_CHUNK_COMPRESSION = true;
+constexpr int CHUNK_COLD_AGE = 5;   // Budget checks
+constexpr int CHUNK_PACK_MAX = 512; // Chunks packed per check
+
+// Chunks whose tile bit layers (walkable, resources, ...) are kept, checked
+// with the memory budget. 512 bytes each.
+constexpr int TILE_BITS_MAX_CHUNKS = 4096;
 
 // ==========================================
 //               Camera
@@ -9,13 +9,15 @@ private:
   // --- Members ---
   Font fontHackRegular;
   int fontSizeDefault;
+  gfx::Sprite firstGlyph; // Glyph i is sprite firstGlyph.id + i
 
 public:
   // --- Constructors ---
   FontHandler();
 
   // --- Core Lifecycle ---
-  void LoadFonts();
+  // Registers the glyphs with 'gfx' for QueueText().
+  void LoadFonts(GFX_Manager *gfx);
   void UnloadFonts();
 
   // --- Graphics / Backbuffer ---
@@ -26,6 +26,8 @@ struct InputCommands {
 
   // Menu
   bool toggleInventory;
+  bool quickSave;
+  bool quickLoad;
 };
 
 struct MouseInput {
@@ -45,7 +47,7 @@ struct World {
   Vector2 hoveredRsrcPoint;
   HexCoord hoveredTileHexCoords;
   Vector2 hoveredTilePoint;
-  MapTile *hoveredTile;
+  MapTile hoveredTile;
 };
 
 struct Screen {
@@ -12,6 +12,7 @@
 #include "structs.h"
 #include "ui_handler.h"
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <mutex>
 #include <thread>
@@ -57,8 +58,10 @@ private:
   bool isUnloaded = false;
 
   // Profiling
+  std::chrono::high_resolution_clock::time_point startTime;
   std::atomic<double> logicExecutionTime;
   std::atomic<double> renderExecutionTime;
+  std::atomic<double> firstFrameTime; // Game() -> first frame with the world
 
   float debugUpdateTimer;
   double displayRenderTime;
@@ -72,8 +75,11 @@ private:
 
   // Logic Thread
   void RunLogic();
+  bool SaveGame();
+  bool LoadGame();
   void LoadBackBuffer();
   void LogicLoop();
+  void UpdateCamera();
   void UpdateFrameContext();
 
 public:
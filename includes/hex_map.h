@@ -0,0 +1,257 @@
+#ifndef HEX_MAP_H
+#define HEX_MAP_H
+
+#include "defines.h"
+#include "hex_math.h"
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/* --- Hex Map ---
+ * Open-addressing hash map keyed by tile, for sparse per-tile data: tile
+ * overlays, running effects, visited sets.
+ *
+ * Keys are (q, r) packed into 64 bits in one flat array, values sit in a
+ * parallel array. A lookup reads one or two cache lines and nothing is
+ * allocated per entry. Slots are found by linear probing from a Fibonacci
+ * hash of the key. Erasing moves the rest of the probe run back instead of
+ * leaving tombstones. The table doubles at 3/4 load.
+ *
+ * HexSet is a HexMap without values, operator[] and Find() do not compile
+ * for it. The tile (INT_MIN, INT_MIN) marks free slots and cannot be
+ * stored.
+ */
+namespace hexmap {
+constexpr u64 Pack(HexCoord h) { return (u64)(u32)h.q << 32 | (u32)h.r; }
+constexpr HexCoord Unpack(u64 key) {
+  return HexCoord((s32)(u32)(key >> 32), (s32)(u32)key);
+}
+
+constexpr u64 FREE = 0x8000000080000000ULL; // Pack((INT_MIN, INT_MIN))
+
+// Value type of a HexSet, takes no space.
+struct None {};
+} // namespace hexmap
+
+template <typename T> class HexMap {
+  static constexpr bool HAS_VALUES = !std::is_empty_v<T>;
+  static constexpr size_t MIN_CAPACITY = 16;
+
+  // --- Members ---
+  std::vector<u64> keys; // hexmap::FREE for free slots
+  std::vector<T> values; // Parallel to 'keys', stays empty for sets
+  size_t size;
+  int shift; // 64 - log2(capacity)
+
+  // --- Private Methods ---
+  size_t Home(u64 key) const {
+    return (size_t)((key * 0x9e3779b97f4a7c15ULL) >> shift);
+  }
+
+  // Slot holding 'key', or the free slot ending its probe run.
+  size_t Probe(u64 key) const {
+    size_t mask = keys.size() - 1;
+    size_t i = Home(key);
+    while (keys[i] != key && keys[i] != hexmap::FREE) {
+      i = (i + 1) & mask;
+    }
+    return i;
+  }
+
+  // Slot of 'key', claimed if it was not in the map.
+  size_t Acquire(u64 key, bool &isInserted) {
+    if ((size + 1) * 4 > keys.size() * 3) {
+      Rehash(keys.empty() ? MIN_CAPACITY : keys.size() * 2);
+    }
+    size_t i = Probe(key);
+    isInserted = keys[i] == hexmap::FREE;
+    if (isInserted) {
+      keys[i] = key;
+      size++;
+    }
+    return i;
+  }
+
+  void Rehash(size_t capacity) {
+    std::vector<u64> oldKeys;
+    std::vector<T> oldValues;
+    oldKeys.swap(keys);
+    keys.assign(capacity, hexmap::FREE);
+    if constexpr (HAS_VALUES) {
+      oldValues.swap(values);
+      values.resize(capacity);
+    }
+    shift = 64;
+    for (size_t c = capacity; c > 1; c >>= 1) {
+      shift--;
+    }
+    for (size_t j = 0; j < oldKeys.size(); j++) {
+      if (oldKeys[j] == hexmap::FREE) {
+        continue;
+      }
+      size_t i = Probe(oldKeys[j]);
+      keys[i] = oldKeys[j];
+      if constexpr (HAS_VALUES) {
+        values[i] = std::move(oldValues[j]);
+      }
+    }
+  }
+
+  // Entries further down the run move into the hole if their home slot
+  // allows it, so probes never have to skip over erased slots.
+  void EraseSlot(size_t i) {
+    size_t mask = keys.size() - 1;
+    for (size_t j = (i + 1) & mask; keys[j] != hexmap::FREE;
+         j = (j + 1) & mask) {
+      // Pinned if its run starts between the hole and itself
+      size_t home = Home(keys[j]);
+      bool isPinned =
+          i <= j ? (i < home && home <= j) : (i < home || home <= j);
+      if (isPinned) {
+        continue;
+      }
+      keys[i] = keys[j];
+      if constexpr (HAS_VALUES) {
+        values[i] = std::move(values[j]);
+      }
+      i = j;
+    }
+    keys[i] = hexmap::FREE;
+    if constexpr (HAS_VALUES) {
+      values[i] = T();
+    }
+    size--;
+  }
+
+public:
+  // --- Constructors ---
+  HexMap() : size(0), shift(64) {}
+
+  // --- Core Lifecycle ---
+  // Room for 'count' entries without growing.
+  void Reserve(size_t count) {
+    size_t capacity = MIN_CAPACITY;
+    while (count * 4 > capacity * 3) {
+      capacity *= 2;
+    }
+    if (capacity > keys.size()) {
+      Rehash(capacity);
+    }
+  }
+
+  // Keeps the capacity.
+  void Clear() {
+    std::fill(keys.begin(), keys.end(), hexmap::FREE);
+    if constexpr (HAS_VALUES) {
+      std::fill(values.begin(), values.end(), T());
+    }
+    size = 0;
+  }
+
+  // Returns false and leaves the value alone if 'h' is in the map already.
+  bool Insert(HexCoord h, const T &value = T()) {
+    bool isInserted;
+    size_t i = Acquire(hexmap::Pack(h), isInserted);
+    if constexpr (HAS_VALUES) {
+      if (isInserted) {
+        values[i] = value;
+      }
+    }
+    return isInserted;
+  }
+
+  // Inserts a default value if 'h' is not in the map.
+  T &operator[](HexCoord h) {
+    static_assert(HAS_VALUES, "HexSet has no values");
+    bool isInserted;
+    return values[Acquire(hexmap::Pack(h), isInserted)];
+  }
+
+  bool Erase(HexCoord h) {
+    if (size == 0) {
+      return false;
+    }
+    size_t i = Probe(hexmap::Pack(h));
+    if (keys[i] == hexmap::FREE) {
+      return false;
+    }
+    EraseSlot(i);
+    return true;
+  }
+
+  // Calls fn(h, value), or fn(h) for sets, and erases the entries it
+  // returns true for. Every entry is visited once.
+  template <typename Fn> void EraseIf(Fn fn) {
+    if (size == 0) {
+      return;
+    }
+    // Start behind a free slot: erasing only pulls entries of the same
+    // run back, never ones that were visited already
+    size_t mask = keys.size() - 1;
+    size_t start = 0;
+    while (keys[start] != hexmap::FREE) {
+      start++;
+    }
+    for (size_t n = 1; n <= mask; n++) {
+      size_t i = (start + n) & mask;
+      while (keys[i] != hexmap::FREE) {
+        bool isErased;
+        if constexpr (HAS_VALUES) {
+          isErased = fn(hexmap::Unpack(keys[i]), values[i]);
+        } else {
+          isErased = fn(hexmap::Unpack(keys[i]));
+        }
+        if (!isErased) {
+          break;
+        }
+        EraseSlot(i);
+      }
+    }
+  }
+
+  // --- Getters ---
+  size_t GetSize() const { return size; }
+  size_t GetCapacity() const { return keys.size(); }
+  size_t GetBytes() const {
+    return keys.capacity() * sizeof(u64) + values.capacity() * sizeof(T);
+  }
+
+  bool Contains(HexCoord h) const {
+    return size != 0 && keys[Probe(hexmap::Pack(h))] != hexmap::FREE;
+  }
+
+  // nullptr if 'h' is not in the map.
+  const T *Find(HexCoord h) const {
+    static_assert(HAS_VALUES, "HexSet has no values");
+    if (size == 0) {
+      return nullptr;
+    }
+    size_t i = Probe(hexmap::Pack(h));
+    return keys[i] != hexmap::FREE ? &values[i] : nullptr;
+  }
+
+  T *Find(HexCoord h) {
+    static_assert(HAS_VALUES, "HexSet has no values");
+    return const_cast<T *>(static_cast<const HexMap &>(*this).Find(h));
+  }
+
+  // Calls fn(h, value), or fn(h) for sets, in slot order.
+  template <typename Fn> void ForEach(Fn fn) const {
+    for (size_t i = 0; i < keys.size(); i++) {
+      if (keys[i] == hexmap::FREE) {
+        continue;
+      }
+      if constexpr (HAS_VALUES) {
+        fn(hexmap::Unpack(keys[i]), values[i]);
+      } else {
+        fn(hexmap::Unpack(keys[i]));
+      }
+    }
+  }
+};
+
+using HexSet = HexMap<hexmap::None>;
+
+#endif // !HEX_MAP_H
@@ -0,0 +1,269 @@
+#ifndef HEX_MATH_H
+#define HEX_MATH_H
+
+#include "raylib.h"
+
+// --- HEXAGON ---
+// Axial tile coordinates, s = -q - r is implied.
+class HexCoord {
+public:
+  int q;
+  int r;
+
+  // Constructors
+  constexpr HexCoord() : q(0), r(0) {}
+  constexpr HexCoord(int q, int r) : q(q), r(r) {}
+
+  // Logic Methods
+  constexpr HexCoord Add(const HexCoord &other) const {
+    return HexCoord(q + other.q, r + other.r);
+  }
+  constexpr bool Equals(const HexCoord &other) const {
+    return q == other.q && r == other.r;
+  }
+
+  // Operators
+  constexpr HexCoord operator+(const HexCoord &other) const {
+    return Add(other);
+  }
+  constexpr HexCoord operator-(const HexCoord &other) const {
+    return HexCoord(q - other.q, r - other.r);
+  }
+  constexpr HexCoord operator*(int k) const { return HexCoord(q * k, r * k); }
+  constexpr bool operator==(const HexCoord &other) const {
+    return Equals(other);
+  }
+  constexpr bool operator!=(const HexCoord &other) const {
+    return !Equals(other);
+  }
+  constexpr bool operator<(const HexCoord &other) const {
+    return q != other.q ? q < other.q : r < other.r;
+  }
+};
+
+/* --- Hex Math ---
+ * Tile geometry, and conversions between axial tiles and world points of
+ * pointy-top hexes, one at a time or in batches.
+ *
+ * The geometry is constexpr and its iterators keep their state by value,
+ * so walking a ring or a line never touches the heap:
+ *
+ *   for (HexCoord h : hexmath::Spiral(center, 1)) { ... }
+ *
+ * Points are relative to the tile drawn at the layout origin:
+ *
+ *   x = originX + colWidth * q + halfCol * r
+ *   y = originY + rowHeight * r
+ *
+ * Batches take structure-of-arrays input, so the kernels load whole
+ * lanes. They run on AVX2 or SSE2 as the build picks (HEXVILE_SIMD in
+ * CMake) and fall back to the scalar loops everywhere else. Both give the
+ * same results, except in the last bit when the compiler fuses the scalar
+ * multiply-adds (FMA).
+ */
+namespace hexmath {
+// --- Geometry ---
+// Neighbor offsets, each one 60 degrees on from the previous.
+inline constexpr HexCoord DIRECTIONS[6] = {{1, 0},  {0, 1},  {-1, 1},
+                                           {-1, 0}, {0, -1}, {1, -1}};
+
+// Steps from (0, 0).
+constexpr int Length(HexCoord h) {
+  auto abs = [](int v) { return v < 0 ? -v : v; };
+  return (abs(h.q) + abs(h.r) + abs(h.q + h.r)) / 2;
+}
+
+constexpr int Distance(HexCoord a, HexCoord b) { return Length(a - b); }
+
+constexpr HexCoord Neighbor(HexCoord h, int direction) {
+  return h + DIRECTIONS[direction];
+}
+
+// Tiles within 'radius' steps of a tile, the tile included.
+constexpr int RangeSize(int radius) { return 3 * radius * (radius + 1) + 1; }
+
+// --- Iterators ---
+// Each one is its own iterator, range-for copies it and compares against
+// End until it runs out.
+struct End {};
+
+// The 6 * radius tiles exactly 'radius' steps away, counter-clockwise.
+// Radius 0 is the center alone.
+class Ring {
+  HexCoord tile;
+  int radius;
+  int side;
+  int step;
+  int left; // Tiles still to visit
+
+public:
+  constexpr Ring(HexCoord center, int radius)
+      : tile(center + DIRECTIONS[4] * radius), radius(radius), side(0),
+        step(0), left(radius == 0 ? 1 : 6 * radius) {}
+
+  constexpr Ring begin() const { return *this; }
+  constexpr End end() const { return End(); }
+  constexpr HexCoord operator*() const { return tile; }
+  constexpr bool operator!=(End) const { return left > 0; }
+  constexpr Ring &operator++() {
+    left--;
+    tile = tile + DIRECTIONS[side];
+    if (++step == radius) {
+      step = 0;
+      side++;
+    }
+    return *this;
+  }
+};
+
+// Tiles within 'radius' steps, nearest first: the center, then ring by
+// ring.
+class Spiral {
+  HexCoord center;
+  int radius;
+  int ringRadius;
+  Ring ring;
+
+public:
+  constexpr Spiral(HexCoord center, int radius)
+      : center(center), radius(radius), ringRadius(0), ring(center, 0) {}
+
+  constexpr Spiral begin() const { return *this; }
+  constexpr End end() const { return End(); }
+  constexpr HexCoord operator*() const { return *ring; }
+  constexpr bool operator!=(End) const { return ring != End(); }
+  constexpr Spiral &operator++() {
+    ++ring;
+    if (!(ring != End()) && ringRadius < radius) {
+      ring = Ring(center, ++ringRadius);
+    }
+    return *this;
+  }
+};
+
+// Tiles within 'radius' steps, row by row like the tile storage.
+class Range {
+  HexCoord center;
+  int radius;
+  int dq;
+  int dr;
+
+  constexpr int RowStart() const { return -radius - (dr < 0 ? dr : 0); }
+  constexpr int RowEnd() const { return radius - (dr > 0 ? dr : 0); }
+
+public:
+  constexpr Range(HexCoord center, int radius)
+      : center(center), radius(radius), dq(0), dr(-radius) {
+    dq = RowStart();
+  }
+
+  constexpr Range begin() const { return *this; }
+  constexpr End end() const { return End(); }
+  constexpr HexCoord operator*() const { return center + HexCoord(dq, dr); }
+  constexpr bool operator!=(End) const { return dr <= radius; }
+  constexpr Range &operator++() {
+    if (++dq > RowEnd()) {
+      dr++;
+      dq = RowStart();
+    }
+    return *this;
+  }
+};
+
+/* Tiles on the straight line from 'from' to 'to', both included, one per
+ * step. Samples the line at every step and rounds to the nearest tile; the
+ * sample points are nudged off tile edges so ties always break the same
+ * way.
+ */
+class Line {
+  HexCoord from;
+  HexCoord to;
+  int steps;
+  int i;
+
+  static constexpr int Round(double v) {
+    int n = (int)v;
+    double f = v - n;
+    return f >= 0.5 ? n + 1 : (f < -0.5 ? n - 1 : n);
+  }
+  static constexpr double Diff(double a, double b) {
+    return a > b ? a - b : b - a;
+  }
+
+public:
+  constexpr Line(HexCoord from, HexCoord to)
+      : from(from), to(to), steps(Distance(from, to)), i(0) {}
+
+  constexpr Line begin() const { return *this; }
+  constexpr End end() const { return End(); }
+  constexpr bool operator!=(End) const { return i <= steps; }
+  constexpr Line &operator++() {
+    i++;
+    return *this;
+  }
+  constexpr HexCoord operator*() const {
+    double t = steps == 0 ? 0.0 : (double)i / steps;
+    double q = from.q + (to.q - from.q) * t + 1e-6;
+    double r = from.r + (to.r - from.r) * t + 2e-6;
+    double s = -q - r;
+    int rq = Round(q);
+    int rr = Round(r);
+    int rs = Round(s);
+    double dq = Diff(rq, q);
+    double dr = Diff(rr, r);
+    double ds = Diff(rs, s);
+    if (dq > dr && dq > ds) {
+      rq = -rr - rs;
+    } else if (dr > ds) {
+      rr = -rq - rs;
+    }
+    return HexCoord(rq, rr);
+  }
+};
+
+// --- Points ---
+struct Layout {
+  float originX;
+  float originY;
+  float colWidth;  // x per q
+  float halfCol;   // x per r
+  float rowHeight; // y per r
+
+  // Inverse, point relative to the origin -> fractional q and r
+  float qPerX;
+  float qPerY;
+  float rPerY;
+};
+
+// 'gapX' and 'gapY' scale a unit hex (sqrt(3) wide, 2 high) to the tile
+// spacing, 'origin' is the center of tile (0, 0).
+Layout MakeLayout(float gapX, float gapY, Vector2 origin);
+
+inline Vector2 ToPoint(const Layout &l, int q, int r) {
+  return {l.colWidth * q + l.halfCol * r + l.originX,
+          l.rowHeight * r + l.originY};
+}
+
+// Tile containing the point, rounded in cube space.
+void ToCoord(const Layout &l, float x, float y, int &q, int &r);
+
+// --- Batches ---
+void ToPoints(const Layout &l, const int *q, const int *r, int count,
+              float *x, float *y);
+// Tiles q0, q0 + 1, ... of row 'r', like a span of the visible window.
+void RowToPoints(const Layout &l, int q0, int r, int count, float *x,
+                 float *y);
+void ToCoords(const Layout &l, const float *x, const float *y, int count,
+              int *q, int *r);
+
+// Plain loops the batches fall back to, public for the benchmark.
+void ToPointsScalar(const Layout &l, const int *q, const int *r, int count,
+                    float *x, float *y);
+void ToCoordsScalar(const Layout &l, const float *x, const float *y,
+                    int count, int *q, int *r);
+
+// "AVX2", "SSE2" or "scalar", whichever the batches were built with.
+const char *GetKernelName();
+} // namespace hexmath
+
+#endif // !HEX_MATH_H
@@ -2,53 +2,43 @@
 #define HEX_TILE_GRid_H
 
 #include "GFX_manager.h"
+#include "autosave.h"
+#include "chunk_store.h"
+#include "chunk_streamer.h"
 #include "defines.h"
 #include "enums.h"
+#include "hex_map.h"
+#include "hex_math.h"
+#include "map_tile.h"
 #include "raylib.h"
 #include "resource.h"
+#include "save_format.h"
 #include "texture.h"
+#include "tile_bits.h"
 #include <atomic>
-#include <future>
+#include <chrono>
+#include <condition_variable>
+#include <iosfwd>
 #include <mutex>
+#include <thread>
 #include <vector>
 
-// --- HEXAGON ---
-class HexCoord {
-public:
-  int q;
-  int r;
-
-  // Constructors
-  HexCoord();
-  HexCoord(int q, int r);
-
-  // Logic Methods
-  HexCoord Add(const HexCoord &other) const;
-  bool Equals(const HexCoord &other) const;
-
-  // Operators
-  HexCoord operator+(const HexCoord &other) const;
-  bool operator==(const HexCoord &other) const;
-  bool operator!=(const HexCoord &other) const;
-  bool operator<(const HexCoord &other) const;
-};
-
-struct FractionalHex {
-  double q, r, s;
-};
-
-// --- Terrain Detail ---
-struct TileDet {
-  Vector2 tilePos;
-  int taOffsetX;
+// --- Visible Window ---
+// Tiles inside the render view, stored as one q span per row:
+// row r covers q in [qMin[r - rMin], qMax[r - rMin]].
+struct VisibleWindow {
+  int rMin = 0;
+  int rMax = -1; // rMin > rMax: empty window
+  std::vector<int> qMin;
+  std::vector<int> qMax;
+  int tileCount = 0;
 };
 
-// --- Map Tile ---
-struct MapTile {
-  tile::id id;
-  TileDet det[conf::TERRAIN_DETAILS_MAX];
-  rsrc::Object rsrc;
-  Vector2 posWorld; // Center of tile
+// --- World Save ---
+// World section of a save file, read and checked by HexGrid::ReadSave().
+struct WorldSave {
+  SaveWorldHeader header;
+  std::vector<chunk::PackedChunk> blocks;
 };
 
 /* Grid parts and relationships:
@@ -62,56 +52,148 @@ struct MapTile {
  *   |q-1,r+1|q ,r+1 |
  */
 class HexGrid {
+  // Times the tile storage and queries, see bench/
+  friend class GridBench;
+
 private:
   // --- Members ---
-  std::vector<MapTile> tileData;
+  // Tiles live in chunks that are allocated on first touch.
+  ChunkStore chunks;
   int gridSize;
 
+  // Writes changed chunks to the journal in the background.
+  Autosave autosave;
+
+  // Bakes details and resources of chunks ahead of the camera.
+  ChunkStreamer streamer;
+  std::vector<StreamRequest> streamWanted;
+  Vector2 prefetchVelocity; // World units per second
+  int streamMisses;         // Tiles rolled in place by the last LoadBackBuffer
+
+  // Chunks out of view are packed, and evicted to disk when over the memory
+  // budget.
+  float evictTimer;
+  std::vector<int> coldSlots;
+
   // --- Dependencies ---
   GFX_Manager *graphicsManager;
 
-  // Stores currently visible tiles for rendering.
-  std::vector<HexCoord> currentVisibleTiles;
+  // Stores currently visible window for rendering.
+  VisibleWindow currentVisibleWindow;
 
-  // Back buffer for visible tiles calculated asynchronously.
-  std::vector<HexCoord> nextVisibleTiles;
+  // Tile centers of the row LoadBackBuffer() is working on.
+  std::vector<float> rowPointsX;
+  std::vector<float> rowPointsY;
+
+  // Back buffer for the visible window calculated asynchronously.
+  VisibleWindow nextVisibleWindow;
+
+  // Last window seen by the visibility thread, the next window is diffed
+  // against it.
+  VisibleWindow prevVisibleWindow;
+
+  // Tiles that entered / left the visible window with the last swap.
+  std::vector<HexCoord> enteredTiles;
+  std::vector<HexCoord> exitedTiles;
+  std::vector<HexCoord> nextEnteredTiles;
+  std::vector<HexCoord> nextExitedTiles;
+
+  // Walkability, resources and edits as bit rows per chunk. Built by the
+  // const queries on first use, logic thread only.
+  mutable TileBits tileBits;
+
+  // Resources with a running hit flash, seconds left per tile. Kept out of
+  // the packed tile data.
+  HexMap<float> flashingTiles;
 
   // Mutex to protect access to visiCache and visiCacheNext during swaps.
+  // Tile data is read through chunk snapshots and never needs it.
   std::mutex visiCacheMutex;
 
-  // Manages the asynchronous calculation of visible tiles.
-  std::future<void> visiCalcFuture;
+  // Long-lived thread calculating the visible tiles.
+  std::thread visiWorker;
+  bool visiWorkerRunning;
+  int visiReaderID; // Snapshot reader slot of the worker
+
+  // Single-slot mailbox for the worker. A newer camera rect overwrites a
+  // request that was not picked up yet.
+  std::mutex visiRequestMutex;
+  std::condition_variable visiRequestCV;
+  bool visiRequestPending;
+  Rectangle visiRequestRect;
+  HexCoord visiRequestAnchor; // Origin tile the rect is relative to
+  std::chrono::high_resolution_clock::time_point visiRequestTime;
+
+  // Time the back buffer's camera rect was requested.
+  std::chrono::high_resolution_clock::time_point nextVisibleRequestTime;
 
   // Flag indicating if visiCacheNext has new data ready to be swapped.
-  bool visiCacheReady;
+  std::atomic<bool> visiCacheReady;
+  bool visiRequestedOnce;
 
   // Profiling
   std::atomic<double> calcVisTime;
+  double visLatency; // Camera rect request -> visible window swapped in
+  double loadTime;   // Last ReadSave() and ApplySave(), ms
+  double spawnTime;  // InitSpawn(), ms
 
   float tileGapX;
   float tileGapY;
+  hexmath::Layout hexLayout; // Tile <-> point constants, from the gaps
   int animationFrame;
-  int mapRadius;
+  int mapRadius; // 0: unbounded
+  u64 worldSeed;
   int tilesInUse;
-  int tilesInTotal;
   Rectangle *camRect;
   Rectangle lastCamRect;
+
+  // Floating origin: world positions are floats relative to the center of
+  // 'originTile', which is drawn at 'origin'. Rebase() moves it along with
+  // the player, so positions stay small however far the world goes.
   Vector2 origin;
+  HexCoord originTile;
 
   // Lookup Tables
-  static const std::vector<HexCoord> DIRECTIONS;
   static const std::vector<tile::id> WALKABLE_TILES;
 
   // --- Private Methods ---
-  HexCoord HexRound(FractionalHex h) const;
-  const MapTile &GetTile(HexCoord h) const;
-  MapTile &GetTile(HexCoord h);
-  TileDet GetRandomTerainDetail(tile::id tileID);
-  rsrc::Object GetRandomTerainResource(tile::id tileID, Vector2 tileWorldPos);
+  tile::id PeekID(HexCoord h) const;
+  tile::id PeekID(const WorldSnapshot *snap, HexCoord h) const;
+  pack::Resource PeekResource(HexCoord h) const;
+  void ReadDetails(HexCoord h, TileDet det[conf::TERRAIN_DETAILS_MAX]) const;
+  rsrc::Object ReadResource(HexCoord h) const;
+  void WriteResource(HexCoord h, const rsrc::Object &rsrc);
+  float GetFlashTimer(HexCoord h) const;
+  void BuildTileBits(int cq, int cr, tilebits::ChunkBits &bits) const;
+  void UpdateTileBits(HexCoord h);
+  // nullptr if the cold copy of the chunk cannot be restored.
+  chunk::Chunk *AcquireChunk(HexCoord h);
+  TileDet RollTerainDetail(HexCoord h, tile::id tileID, int index) const;
+  rsrc::Object RollTerainResource(HexCoord h, tile::id tileID,
+                                  Vector2 tileCenter) const;
+  Vector2 CoordToPoint(int q, int r, HexCoord anchor) const;
   void CalcRenderRect();
-  void CalcVisibleTiles();
+  Rectangle CalcRenderView(Rectangle camView) const;
+  void UpdateStreaming(float deltaTime);
+  void CollectChunks(Rectangle view, std::vector<StreamRequest> &out);
+  void BakeChunk(const WorldSnapshot *snap, BakedChunk &b) const;
+  void VisibilityWorkerLoop();
+  void RequestVisibleTiles(Rectangle camView);
+  void CalcVisibleTiles(
+      Rectangle camView, HexCoord anchor,
+      std::chrono::high_resolution_clock::time_point requestTime);
+  void CalcVisibleRows(Rectangle view, HexCoord anchor, int &rMin,
+                       int &rMax) const;
+  void CalcVisibleCols(Rectangle view, HexCoord anchor, int r, int &qMin,
+                       int &qMax) const;
+  void CalcVisibleWindow(Rectangle view, HexCoord anchor,
+                         VisibleWindow &w) const;
+  void DiffVisibleWindows(const WorldSnapshot *snap, const VisibleWindow &from,
+                          const VisibleWindow &to,
+                          std::vector<HexCoord> &out) const;
   void UpdateTileVisibility(float totalTime);
   void UpdateTilesProperties();
+  void LoadTileBackBuffer(HexCoord h, Vector2 tileCenter);
   void LoadTileGFX(Rectangle destRec, int x, int y);
   void LoadDetailGFX(Rectangle destRec, const TileDet d, tile::id tileID);
   void LoadResourceGFX(Rectangle destRec, const rsrc::Object r,
@@ -120,15 +202,37 @@ private:
 public:
   // --- Constructors ---
   HexGrid();
+  ~HexGrid();
 
   // --- Core Lifecycle ---
   void InitGrid(float radius);
+  // Prepares the area under 'camView' for the first frame: unpacks and
+  // bakes its chunks on every core and computes the visible window. Call
+  // once after loading, before the first Update(). Chunks further out are
+  // streamed in the background.
+  void InitSpawn(Rectangle camView);
   void Update(const Camera2D &camera, float totalTime);
+  // Moves the origin to the tile under 'focus' once it is more than
+  // ORIGIN_REBASE_DISTANCE away. Returns the offset to subtract from every
+  // world position kept outside the grid, {0, 0} if the origin stayed.
+  Vector2 Rebase(Vector2 focus);
   void Shutdown();
   bool RemoveResource(HexCoord h, int rsrcID);
   bool DamageResource(HexCoord h, int rsrcID, int damage);
   bool CheckObstacleCollision(Vector2 worldPos, float radius);
 
+  // --- Save / Load ---
+  bool Save(std::ostream &out) const;
+  // Loading is split so a damaged save never replaces the world: ReadSave()
+  // reads and checks the world section without changing the grid, then
+  // ApplySave() swaps it in and cannot fail.
+  bool ReadSave(std::istream &in, WorldSave &save);
+  void ApplySave(WorldSave &save);
+  // The journal holds the changes since the last full save. Reset it after
+  // saving or when reverting to a save, replay it after loading at startup.
+  void ResetAutosave();
+  int ReplayAutosave();
+
   // --- Graphics / Backbuffer ---
   void LoadBackBuffer();
   void DrawTile(HexCoord h, tex::atlas::Coords taCoords, drawMask::id layerID);
@@ -136,28 +240,55 @@ public:
   // --- Setters ---
   void SetGFX_Manager(GFX_Manager *graphicsManager);
   void SetCamRectPointer(Rectangle *camRect);
+  // Movement of the camera target, chunks ahead of it are baked first.
+  void SetPrefetchVelocity(Vector2 velocity);
   bool SetTile(HexCoord h, tile::id tileID);
 
   // --- Getters ---
   int GetTilesInUse() const;
   int GetTilesInTotal() const;
   int GetTilesVisible() const;
+  const std::vector<HexCoord> &GetEnteredTiles() const;
+  const std::vector<HexCoord> &GetExitedTiles() const;
+  int GetChunksLoaded() const;
+  size_t GetTileMemoryUsage() const;
   int GetMapRadius() const;
+  HexCoord GetOriginTile() const;
+  bool IsUnbounded() const;
   bool IsInBounds(HexCoord h) const;
   bool HasTile(HexCoord h) const;
   bool IsWalkable(HexCoord h) const;
+  bool HasResourceInRange(HexCoord center, int radius) const;
+  // Tiles within 'radius' steps of 'center' that have 'layer' set.
+  int CountTilesInRange(HexCoord center, int radius,
+                        tilebits::Layer layer) const;
   bool CheckSurrounded(HexCoord target) const;
   double GetVisCalcTime() const;
+  double GetVisLatency() const;
+  double GetLoadTime() const;
+  double GetSpawnTime() const;
+  double GetAutosaveSnapshotTime() const;
+  size_t GetAutosaveBytesWritten() const;
+  int GetChunksBaked() const;
+  double GetStreamBakeTime() const;
+  int GetStreamMisses() const;
+  int GetChunksEvicted() const;
+  int GetEvictCount() const;
+  int GetReloadCount() const;
+  double GetEvictTime() const;
+  double GetReloadTime() const;
+  int GetChunksPacked() const;
+  size_t GetPackedBytes() const;
+  double GetPackRate() const;
+  double GetUnpackRate() const;
   rsrc::Object GetResource(HexCoord h) const;
 
   // --- Conversions / Helpers ---
   HexCoord PointToHexCoord(Vector2 point) const;
   Vector2 HexCoordToPoint(HexCoord h) const;
   Vector2 CoordToPoint(int q, int r) const;
-  MapTile *HexCoordToTile(HexCoord h);
-  const MapTile *HexCoordToTile(HexCoord h) const;
-  MapTile *PointToTile(Vector2 point);
-  const MapTile *PointToTile(Vector2 point) const;
+  MapTile HexCoordToTile(HexCoord h) const;
+  MapTile PointToTile(Vector2 point) const;
   tile::id PointToType(Vector2 point) const;
   tile::id HexCoordToType(HexCoord h) const;
   const char *TileToString(tile::id tileID) const;
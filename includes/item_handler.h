@@ -3,6 +3,7 @@
 
 #include "enums.h"
 #include "frame_context.h"
+#include <iosfwd>
 #include <vector>
 
 // --- Structs ---
@@ -23,6 +24,8 @@ private:
 
   // --- Private Methods ---
   void Init();
+  static void SaveContainer(std::ostream &out, const ItemContainer &c);
+  static bool LoadContainer(std::istream &in, ItemContainer &c);
 
 public:
   // --- Constructors ---
@@ -32,6 +35,10 @@ public:
   bool TakeItemFromToolBar(ItemStack *itemStack, int amount);
   bool AddItem(item::id itemID, int count);
 
+  // --- Save / Load ---
+  bool Save(std::ostream &out) const;
+  bool Load(std::istream &in);
+
   // --- Setters ---
   void SetFrameContext(const frame::Context *curFrameContext);
 
@@ -0,0 +1,46 @@
+#ifndef MAP_TILE_H
+#define MAP_TILE_H
+
+#include "defines.h"
+#include "enums.h"
+#include "raylib.h"
+#include "resource.h"
+
+// --- Terrain Detail ---
+struct TileDet {
+  Vector2 tilePos;
+  int taOffsetX;
+};
+
+// --- Map Tile ---
+// Assembled view of one tile. Chunks store each property in its own array,
+// see chunk::Chunk.
+struct MapTile {
+  tile::id id;
+  TileDet det[conf::TERRAIN_DETAILS_MAX];
+  rsrc::Object rsrc;
+  Vector2 posWorld; // Center of tile
+};
+
+/* --- Packed Tile ---
+ * Compact encoding of a modified resource. Derivable data is not stored:
+ * the tile center comes from (q, r), static resource data from
+ * rsrc::ID_LUT and hit flashes are tracked by HexGrid. Details are never
+ * stored, they are regenerated from the world seed.
+ *
+ *   Resource (u16) id + 2 (2 bit), hp (7 bit), x + 3, y + 3 (3 bit)
+ *
+ * Positions are offsets from the tile center. Every field is biased so a
+ * zeroed word decodes to UNINITIALIZED, which marks an untouched resource.
+ */
+namespace pack {
+using Resource = u16;
+
+constexpr Resource RESOURCE_PRISTINE = 0;
+
+Resource EncodeResource(const rsrc::Object &rsrc, Vector2 tileCenter);
+rsrc::Object DecodeResource(Resource bits, Vector2 tileCenter);
+rsrc::ID DecodeResourceID(Resource bits);
+} // namespace pack
+
+#endif // !MAP_TILE_H
@@ -0,0 +1,18 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <functional>
+
+/* --- Parallel ---
+ * Fans a loop out over every core for one-off bulk work, like preparing
+ * the spawn area at startup. Threads live for one call, there is no pool.
+ */
+namespace parallel {
+// Threads For() uses, including the calling one.
+int GetWorkerCount();
+// Calls fn(i, worker) for every i in [0, count) and returns when all are
+// done. 'worker' is in [0, GetWorkerCount()), for per-thread scratch data.
+void For(int count, const std::function<void(int, int)> &fn);
+} // namespace parallel
+
+#endif // !PARALLEL_H
@@ -25,6 +25,7 @@ private:
   playerState::id stateID;
   faceDir::id faceDirID;
   Vector2 moveDir;
+  Vector2 velocity; // World units per second
   float moveSpeed;
   float speedTilesPerSecond;
 
@@ -57,12 +58,15 @@ public:
   void SetUI_Handler(UI_Handler *ui_handler);
   void SetItemHandler(ItemHandler *itemHandler);
   void SetFrameContext(const frame::Context *frameContext);
+  // The world origin moved by 'offset', keeps the player on its tile.
+  void Shift(Vector2 offset);
 
   // --- Getters ---
   Vector2 GetPosition() const;
   HexCoord GetTile() const;
   int GetAnimationFrame() const;
   float GetSpeedTilesPerSecond() const;
+  Vector2 GetVelocity() const;
   const char *PlayerStateToString() const;
   const char *PlayerDirToString() const;
 };
@@ -35,6 +35,9 @@ constexpr Object OBJECT_TREE = {POS_NULL, tex::atlas::TREE, 100, ID_TREE, 1,
 constexpr Object OBJECT_ROCK = {POS_NULL, tex::atlas::STONE, 100, ID_ROCK, 5,
                                 0.0f};
 
+// Static data per resource, indexed by ID
+constexpr Object ID_LUT[] = {OBJECT_TREE, OBJECT_ROCK};
+
 inline const std::map<tile::id, Object> TILE_LUT = {
     {tile::GRASS, OBJECT_TREE},
     {tile::WATER, OBJECT_NULL},
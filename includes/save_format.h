@@ -0,0 +1,44 @@
+#ifndef SAVE_FORMAT_H
+#define SAVE_FORMAT_H
+
+#include "defines.h"
+
+/* --- Save File ---
+ * Sections follow each other, all values little endian:
+ *
+ *   SaveHeader
+ *   SaveWorldHeader
+ *   u32 chunkCount, then per chunk:
+ *     SaveChunkHeader
+ *     u8 data[packedSize]          codec::Compress(codec::EncodeChunk())
+ *   u32 containerCount, then per container:
+ *     u32 stackCount, then stackCount * (s32 itemID, s32 count)
+ *
+ * Chunks are self-contained, loading streams them one at a time. Chunks
+ * without edits are not written, the seed regenerates them. They are keyed
+ * by chunk coordinates, directory slots of unbounded worlds differ between
+ * sessions.
+ */
+constexpr char SAVE_MAGIC[4] = {'H', 'X', 'V', 'S'};
+constexpr u32 SAVE_VERSION = 3;
+
+struct SaveHeader {
+  char magic[4];
+  u32 version;
+};
+
+struct SaveWorldHeader {
+  u16 chunkShift;
+  u16 tileOrder; // chunk::TILE_ORDER, block indices follow it
+  s32 mapRadius; // 0: unbounded
+  u64 seed;
+};
+
+struct SaveChunkHeader {
+  s32 cq; // ChunkStore::ChunkCoord()
+  s32 cr;
+  u32 rawSize;
+  u32 packedSize;
+};
+
+#endif // !SAVE_FORMAT_H
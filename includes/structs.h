@@ -18,8 +18,30 @@ struct RenderState {
   int tilesTotal;
   int tilesUsed;
   int tilesVisible;
+  int tilesEntered;
+  int tilesExited;
   int mapRadius;
+  int chunksLoaded;
+  double tileMemoryMB;
   double visCalcTime;
+  double visLatency;
+  double worldLoadTime;
+  double spawnTime;
+  double firstFrameTime;
+  double autosaveSnapshotTime;
+  double autosaveKB;
+  int chunksBaked;
+  double streamBakeTime;
+  int streamMisses;
+  int chunksEvicted;
+  int evictCount;
+  int reloadCount;
+  double evictTime;
+  double reloadTime;
+  int chunksPacked;
+  double packedKB;
+  double packRate;   // Bytes per us, i.e. MB/s
+  double unpackRate; // Bytes per us
 
   // Mouse Hover
   HexCoord mouseTileCoord;
@@ -29,6 +51,7 @@ struct RenderState {
   Vector2 playerPos;
   HexCoord playerTileCoord;
   tile::id playerTileID;
+  HexCoord originTile; // Tile at the world origin
   std::string playerStateStr;
   std::string playerDirStr;
   int playerFrame;
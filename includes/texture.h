@@ -12,18 +12,12 @@ struct Opts {
   Color color = WHITE;
   bool useHitShader = false;
 
-  float srcWidth = 0.0f;
-  float srcHeight = 0.0f;
-  float dstWidth = 0.0f;
-  float dstHeight = 0.0f;
-  float dstRecY = 0.0f;
-
   float scale = 1.0f;
 
   float sortingOffsetY = 0.0f;
 
+  // Fraction of the drawn size
   Vector2 origin = {0.5f, 1.0f};
-  bool ignoreRelativeOrigin = false;
 };
 
 // ==========================================
@@ -78,6 +72,9 @@ constexpr Coords ITEM_SLOT_HIGHLIGHTED = {57, 1};
 constexpr Coords TILE_HIGHLIGHTED = {58, 1};
 constexpr Coords INVENTORY = {52, 1, 4, 3};
 
+// Sprites larger than one cell get their own rect at load
+constexpr Coords LARGE_SPRITES[] = {TREE, INVENTORY};
+
 // --- Number ---
 constexpr Coords NUMBER = {52, 0};
 
@@ -0,0 +1,118 @@
+#ifndef TILE_BITS_H
+#define TILE_BITS_H
+
+#include "chunk_store.h"
+#include "defines.h"
+#include "hex_map.h"
+#include "hex_math.h"
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+/* Per-property bit layers of the tiles, one word per chunk row:
+ *
+ *   bit lq of rows[layer][lr] is tile (q0 + lq, r0 + lr)
+ *
+ * where (q0, r0) is the first tile of the chunk. Rows are always in this
+ * order, whatever TILE_ORDER the chunk store uses. A point query tests one
+ * bit. Area queries mask the words of each tile row and count them, 32
+ * tiles per operation, and stop at the first set bit for "any".
+ */
+namespace tilebits {
+enum Layer : int {
+  WALKABLE = 0, // Tile id in conf::WALKABLE_TILE_IDS
+  HAS_RESOURCE, // Any resource on the tile
+  BLOCKS,       // Resource the player collides with (trees)
+  MODIFIED,     // Written since generation, stored by the chunk store
+  LAYERS,
+};
+
+using Row = u32;
+static_assert(chunk::SIZE <= 32, "Chunk row does not fit a Row");
+
+struct ChunkBits {
+  Row rows[LAYERS][chunk::SIZE];
+};
+
+// Bits lo..hi of a row, both included.
+constexpr Row SpanMask(int lo, int hi) {
+  return (Row)(((u64)2 << hi) - ((u64)1 << lo));
+}
+} // namespace tilebits
+
+/* --- Tile Bits ---
+ * Bit layers of the chunks that were queried recently.
+ *
+ * The layers are derived from the tile data. A chunk's words are built on
+ * its first query and kept in step by Set() for every tile the grid writes.
+ * The build reads the chunk through the chunk store, which unpacks or
+ * reloads it if it is cold. Queries of built chunks never touch the tile
+ * data. Chunks follow the chunk store's grid, a build reads one stored and
+ * one baked chunk.
+ *
+ * Logic thread only.
+ */
+class TileBits {
+public:
+  // Fills every layer of chunk (cq, cr) from the tile data.
+  using BuildFunc = std::function<void(int cq, int cr, tilebits::ChunkBits &)>;
+
+private:
+  // --- Members ---
+  HexMap<int> index; // Chunk coordinates -> entry
+  std::vector<tilebits::ChunkBits> entries;
+  std::vector<HexCoord> entryChunks; // Chunk coordinates per entry
+  std::vector<u32> lastUsed;         // Trim() round of the last query
+  u32 useClock;
+  // Entry of the last query, rows of an area mostly hit the same chunk
+  HexCoord lastChunk;
+  int lastEntry; // -1: none
+
+  // --- Dependencies ---
+  const ChunkStore *chunks;
+  BuildFunc build;
+
+  // --- Private Methods ---
+  const tilebits::ChunkBits &Acquire(int cq, int cr);
+  void Drop(HexCoord chunkCoords);
+  template <typename Span, typename Fn>
+  bool ForEachWord(tilebits::Layer layer, int rMin, int rMax, Span span,
+                   Fn fn);
+  template <typename Span>
+  int CountIn(tilebits::Layer layer, int rMin, int rMax, Span span);
+  template <typename Span>
+  bool AnyIn(tilebits::Layer layer, int rMin, int rMax, Span span);
+
+public:
+  // --- Constructors ---
+  TileBits();
+
+  // --- Core Lifecycle ---
+  void Init(const ChunkStore *chunks, BuildFunc build);
+  // The tile data was replaced, every chunk is built again on demand.
+  void Clear();
+  // Drops the chunks queried the longest time ago until at most 3/4 of
+  // 'maxChunks' are left, once there are more than 'maxChunks'. Starts a
+  // new round.
+  void Trim(int maxChunks);
+
+  // --- Queries ---
+  bool Test(HexCoord h, tilebits::Layer layer);
+  // Tiles of row 'r' from 'qMin' to 'qMax' with the bit set.
+  int CountRow(tilebits::Layer layer, int r, int qMin, int qMax);
+  bool AnyInRow(tilebits::Layer layer, int r, int qMin, int qMax);
+  // Tiles within 'radius' steps of 'center' with the bit set.
+  int CountInRange(tilebits::Layer layer, HexCoord center, int radius);
+  bool AnyInRange(tilebits::Layer layer, HexCoord center, int radius);
+
+  // --- Setters ---
+  // Call for every tile write. Chunks that are not built are left alone,
+  // their build reads the new data.
+  void Set(HexCoord h, tilebits::Layer layer, bool isSet);
+
+  // --- Getters ---
+  int GetChunksBuilt() const;
+  size_t GetBytes() const;
+};
+
+#endif // !TILE_BITS_H
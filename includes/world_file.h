@@ -0,0 +1,69 @@
+#ifndef WORLD_FILE_H
+#define WORLD_FILE_H
+
+#include "defines.h"
+#include <cstddef>
+
+/* --- World File ---
+ * Fixed binary layout, all values little endian:
+ *
+ *   WorldFileHeader
+ *   u8 used[slots]                   1 if the record holds a chunk
+ *   (padding to WORLD_FILE_PAGE)
+ *   records[slots]                   recordSize bytes each, page aligned
+ *
+ * A new file is only truncated to size, the OS hands out zero pages on
+ * first touch. Opening an existing world maps it without reading records.
+ */
+constexpr char WORLD_FILE_MAGIC[4] = {'H', 'X', 'V', 'W'};
+constexpr u32 WORLD_FILE_VERSION = 2;
+constexpr size_t WORLD_FILE_PAGE = 4096;
+
+struct WorldFileHeader {
+  char magic[4];
+  u32 version;
+  u16 chunkShift;
+  u16 tileOrder; // chunk::TILE_ORDER
+  s32 mapRadius;
+  u64 seed;
+  u32 slots;
+  u32 recordSize;
+};
+
+class WorldFile {
+private:
+  // --- Members ---
+  int fd;
+  u8 *base;
+  size_t size;
+  u8 *used;
+  u8 *records;
+  u32 slots;
+  size_t recordSize;
+
+public:
+  // --- Constructors ---
+  WorldFile();
+  ~WorldFile();
+  WorldFile(const WorldFile &) = delete;
+  WorldFile &operator=(const WorldFile &) = delete;
+
+  // --- Core Lifecycle ---
+  // Maps 'path', creating it if missing. Fails if an existing file was
+  // written with a different header.
+  bool Open(const char *path, const WorldFileHeader &header);
+  void Close();
+  void Sync();
+
+  // --- Records ---
+  bool IsUsed(int slot) const;
+  void MarkUsed(int slot);
+  void MarkFree(int slot);
+  void *Record(int slot) const;
+
+  // --- Getters ---
+  bool IsOpen() const;
+  bool Contains(const void *p) const;
+};
+
+#endif // !WORLD_FILE_H
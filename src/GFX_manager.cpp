@@ -5,6 +5,7 @@
 #include "texture.h"
 #include <algorithm>
 #include <iostream>
+#include <vector>
 
 // --- Constructors ---
 GFX_Manager::GFX_Manager() {
@@ -38,97 +39,108 @@ void GFX_Manager::UnloadAssets() {
   UnloadShader(this->hitShader);
 }
 
-// --- Graphics / Backbuffer ---
-void GFX_Manager::LoadTextureToBackbuffer(drawMask::id layerID,
-                                          tex::atlas::Coords coords,
-                                          Vector2 dst, tex::Opts opts) {
-
-  Rectangle srcRec = GetSrcRec(coords.x, coords.y);
-  Rectangle dstRec = {dst.x, dst.y, tex::size::TILE, tex::size::TILE};
-
-  if (coords.height > 1) {
-    srcRec.height = coords.height * tex::size::TILE;
-    dstRec.height = coords.height * tex::size::TILE;
-  }
-
-  if (coords.width > 1) {
-    srcRec.width = coords.width * tex::size::TILE;
-    dstRec.width = coords.width * tex::size::TILE;
-  }
-
-  if (opts.srcWidth != 0.0f) {
-    srcRec.width = opts.srcWidth;
-  }
-
-  if (opts.srcHeight != 0.0f) {
-    srcRec.height = opts.srcHeight;
-  }
-
-  if (opts.dstWidth != 0.0f)
-    dstRec.width = opts.dstWidth;
-
-  if (opts.dstHeight != 0.0f) {
-    dstRec.height = opts.dstHeight;
+gfx::Sprite GFX_Manager::AddTexture(Texture2D texture, const Rectangle *recs,
+                                    int count) {
+  gfx::Sprite first = {(u16)spriteRecs.size(), (u8)textures.size()};
+  if (textures.size() > UINT8_MAX ||
+      spriteRecs.size() + count > (size_t)UINT16_MAX + 1) {
+    std::cout << "Error registering texture, tables are full" << std::endl;
+    return {0, 0};
   }
+  textures.push_back(texture);
+  spriteRecs.insert(spriteRecs.end(), recs, recs + count);
+  return first;
+}
 
-  if (opts.dstRecY != 0.0f) {
-    dstRec.y += opts.dstRecY;
-  }
+// --- Graphics / Backbuffer ---
+// Whether 'value' fits 'max' fixed-point steps of 'one'.
+static constexpr bool FitsFixed(float value, int one, int max) {
+  return value >= 0.0f && value * one + 0.5f < max + 1.0f;
+}
 
-  if (opts.scale != 1.0f) {
-    dstRec.width *= opts.scale;
-    dstRec.height *= opts.scale;
+// Options that pack without clamping.
+static constexpr bool FitsCommand(const tex::Opts &opts) {
+  return FitsFixed(opts.scale, gfx::SCALE_ONE, UINT16_MAX) &&
+         FitsFixed(opts.origin.x, gfx::ORIGIN_ONE, UINT8_MAX) &&
+         FitsFixed(opts.origin.y, gfx::ORIGIN_ONE, UINT8_MAX);
+}
+static_assert(FitsCommand(tex::Opts{}) && FitsCommand(tex::opts::NUMBERS) &&
+                  FitsCommand(tex::opts::ITEM_SLOT) &&
+                  FitsCommand(tex::opts::ITEM_ICON) &&
+                  FitsCommand(tex::opts::IVENTORY),
+              "tex::opts do not fit gfx::Command");
+
+// 'value' in fixed-point steps of 'one', clamped to 0..'max'.
+static int ToFixed(float value, int one, int max) {
+  if (!(value >= 0.0f)) {
+    return 0;
   }
+  return (int)std::min(value * one + 0.5f, (float)max);
+}
 
-  Vector2 origin = opts.origin;
-  if (!opts.ignoreRelativeOrigin) {
-    origin.x *= dstRec.width;
-    origin.y *= dstRec.height;
+void GFX_Manager::LoadTextureToBackbuffer(drawMask::id layerID,
+                                          tex::atlas::Coords coords,
+                                          Vector2 dst, tex::Opts opts) {
+  // Reported once, the same options are drawn every frame
+  static bool isRangeReported = false;
+  if (!isRangeReported && !FitsCommand(opts)) {
+    std::cout << "Error: draw scale " << opts.scale << " or origin ("
+              << opts.origin.x << ", " << opts.origin.y
+              << ") out of range, clamped" << std::endl;
+    isRangeReported = true;
   }
-
-  GFX_Data_Buffers[backBufferIndex][static_cast<int>(layerID)].push_back(
-      {dst.y + opts.sortingOffsetY, textureAtlas, srcRec, dstRec, origin,
-       opts.color, opts.useHitShader});
+  gfx::Sprite sprite = GetAtlasSprite(coords);
+  GFX_Data_Buffers[backBufferIndex][layerID].push_back(
+      {dst.y + opts.sortingOffsetY, dst.x, dst.y, sprite.id,
+       (u16)ToFixed(opts.scale, gfx::SCALE_ONE, UINT16_MAX), sprite.texture,
+       (u8)(opts.useHitShader ? gfx::HIT_SHADER : 0),
+       (u8)ToFixed(opts.origin.x, gfx::ORIGIN_ONE, UINT8_MAX),
+       (u8)ToFixed(opts.origin.y, gfx::ORIGIN_ONE, UINT8_MAX), opts.color});
 }
 
-void GFX_Manager::LoadTextureToBackbuffer_Raw(drawMask::id layerID,
-                                              Texture2D texture,
-                                              Rectangle srcRec,
-                                              Rectangle dstRec,
-                                              tex::Opts opts) {
-  Vector2 origin = opts.origin;
-  if (!opts.ignoreRelativeOrigin) {
-    origin.x *= dstRec.width;
-    origin.y *= dstRec.height;
-  }
-
-  // Write to Back Buffer
-  GFX_Data_Buffers[backBufferIndex][static_cast<int>(layerID)].push_back(
-      {dstRec.y + opts.sortingOffsetY, texture, srcRec, dstRec, origin,
-       opts.color, opts.useHitShader});
+void GFX_Manager::SortBackBuffer() {
+  auto &layers = GFX_Data_Buffers[backBufferIndex];
+  for (int i = 0; i < drawMask::SIZE; i++) {
+    std::vector<gfx::Command> &layer = layers[i];
+    switch (gfx::LAYER_SORT[i]) {
+    case gfx::UNSORTED:
+      break;
+    case gfx::PRESORTED:
+      // One pass to check, a producer that broke the order gets a sort
+      if (!std::is_sorted(layer.begin(), layer.end(),
+                          [](const gfx::Command &a, const gfx::Command &b) {
+                            return a.sortY < b.sortY;
+                          })) {
+        SortLayer(layer);
+      }
+      break;
+    case gfx::SORT_BY_Y:
+      SortLayer(layer);
+      break;
+    }
+  }
 }
 
 void GFX_Manager::RenderLayer(drawMask::id maskID) {
-  // Read from Front Buffer (1 - backBufferIndex)
+  // Read from Front Buffer (1 - backBufferIndex), ordered by SortBackBuffer()
+  // (Painter's Algorithm)
   int frontIndex = 1 - backBufferIndex;
   auto &layer = GFX_Data_Buffers[frontIndex][static_cast<int>(maskID)];
 
-  // Sort objects by Y position (Painter's Algorithm)
-  std::sort(layer.begin(), layer.end(),
-            [](const gfx::Object &a, const gfx::Object &b) {
-              return a.sortY < b.sortY;
-            });
-
-  for (auto &item : layer) {
-    // GFX_Props &props = item.props;
+  for (const gfx::Command &c : layer) {
+    Rectangle srcRec = spriteRecs[c.sprite];
+    float scale = c.scale * (1.0f / gfx::SCALE_ONE);
+    Rectangle dstRec = {c.x, c.y, srcRec.width * scale, srcRec.height * scale};
+    Vector2 origin = {c.originX * (1.0f / gfx::ORIGIN_ONE) * dstRec.width,
+                      c.originY * (1.0f / gfx::ORIGIN_ONE) * dstRec.height};
 
-    if (item.useHitShader)
+    if (c.flags & gfx::HIT_SHADER)
       BeginShaderMode(hitShader);
 
-    DrawTexturePro(item.texture, item.srcRec, item.dstRec, item.origin, 0.0f,
-                   item.color);
+    DrawTexturePro(textures[c.texture], srcRec, dstRec, origin, 0.0f,
+                   c.color);
 
-    if (item.useHitShader)
+    if (c.flags & gfx::HIT_SHADER)
       EndShaderMode();
   }
   // Do NOT clear here. We clear the *new* back buffer in SwapBuffers.
@@ -149,25 +161,90 @@ void GFX_Manager::SwapBuffers() {
 Rectangle GFX_Manager::GetTileRec(tile::id tileID, int frame) {
   int x_idx = (tex::atlas::TILE_X / tex::size::TILE) + frame;
   int y_idx = static_cast<int>(tileID);
-  return textureRecData[y_idx][x_idx];
+  return spriteRecs[y_idx * TA_Width + x_idx];
 }
 
 // --- Private Methods ---
 void GFX_Manager::InitTextureRec() {
-
-  float reso = static_cast<float>(tex::size::TILE);
-  textureRecData.resize(TA_Height);
+  float reso = tex::size::TILE;
+  textures.assign(1, textureAtlas);
+  spriteRecs.clear();
+  largeSprites.clear();
 
   for (int y = 0; y < TA_Height; y++) {
-    textureRecData[y].resize(TA_Width);
     for (int x = 0; x < TA_Width; x++) {
+      spriteRecs.push_back({x * reso, y * reso, reso, reso});
+    }
+  }
+  for (tex::atlas::Coords c : tex::atlas::LARGE_SPRITES) {
+    largeSprites.push_back({c, (u16)spriteRecs.size()});
+    spriteRecs.push_back(
+        {c.x * reso, c.y * reso, c.width * reso, c.height * reso});
+  }
+}
 
-      float xOffset = static_cast<float>(x * reso);
-      float yOffset = static_cast<float>(y * reso);
-      textureRecData[y][x] =
-          Rectangle{.x = xOffset, .y = yOffset, .width = reso, .height = reso};
+gfx::Sprite GFX_Manager::GetLargeSprite(tex::atlas::Coords coords) const {
+  for (const auto &[c, id] : largeSprites) {
+    if (c.x == coords.x && c.y == coords.y && c.width == coords.width &&
+        c.height == coords.height) {
+      return {id, 0};
     }
   }
+  // Not in tex::atlas::LARGE_SPRITES, draw its top left cell. Reported
+  // once, the same sprite is drawn every frame.
+  static bool isMissReported = false;
+  if (!isMissReported) {
+    std::cout << "Error: atlas sprite (" << coords.x << ", " << coords.y
+              << ") of " << coords.width << "x" << coords.height
+              << " cells is not in tex::atlas::LARGE_SPRITES" << std::endl;
+    isMissReported = true;
+  }
+  return {(u16)(coords.y * TA_Width + coords.x), 0};
 }
 
-Rectangle GFX_Manager::GetSrcRec(int x, int y) { return textureRecData[y][x]; }
\ No newline at end of file
+/* Stable LSD radix sort by sortY, quantized to GFX_SORT_KEY_STEPS per world
+ * unit above the smallest sortY of the layer. Sorts (key, index) pairs 8 key
+ * bits per pass and skips the passes above the largest key, a screen of
+ * commands takes 2. The commands are moved once at the end.
+ */
+void GFX_Manager::SortLayer(std::vector<gfx::Command> &layer) {
+  size_t count = layer.size();
+  if (count < 2) {
+    return;
+  }
+  float minY = layer[0].sortY;
+  for (const gfx::Command &c : layer) {
+    minY = std::min(minY, c.sortY);
+  }
+
+  sortItems.resize(count);
+  sortItemsScratch.resize(count);
+  u32 maxKey = 0;
+  for (size_t i = 0; i < count; i++) {
+    float steps = (layer[i].sortY - minY) * conf::GFX_SORT_KEY_STEPS;
+    u32 key = (u32)std::min(steps, 4294967040.0f); // Largest float < 2^32
+    maxKey = std::max(maxKey, key);
+    sortItems[i] = (u64)key << 32 | i;
+  }
+
+  for (int shift = 32; shift < 64 && (maxKey >> (shift - 32)) != 0;
+       shift += 8) {
+    size_t offsets[257] = {};
+    for (u64 item : sortItems) {
+      offsets[((item >> shift) & 0xff) + 1]++;
+    }
+    for (int d = 1; d < 257; d++) {
+      offsets[d] += offsets[d - 1];
+    }
+    for (u64 item : sortItems) {
+      sortItemsScratch[offsets[(item >> shift) & 0xff]++] = item;
+    }
+    sortItems.swap(sortItemsScratch);
+  }
+
+  sortedCommands.clear();
+  for (u64 item : sortItems) {
+    sortedCommands.push_back(layer[(u32)item]);
+  }
+  layer.swap(sortedCommands);
+}
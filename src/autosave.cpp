@@ -0,0 +1,197 @@
+#include "autosave.h"
+#include "chunk_codec.h"
+#include "chunk_store.h"
+#include "defines.h"
+#include "save_format.h"
+#include <chrono>
+#include <cstring>
+#include <fstream>
+
+// --- Constructors ---
+Autosave::Autosave() {
+  chunks = nullptr;
+  worldHeader = {};
+  readerID = -1;
+  timer = 0.0f;
+  isRunning = false;
+  isBusy = false;
+  jobSnapshot = nullptr;
+  snapshotTime = 0.0;
+  writeTime = 0.0;
+  bytesWritten = 0;
+}
+
+Autosave::~Autosave() { Stop(); }
+
+// --- Core Lifecycle ---
+void Autosave::Start(ChunkStore *chunks, const char *path,
+                     const SaveWorldHeader &header) {
+  if (worker.joinable()) {
+    return;
+  }
+  this->chunks = chunks;
+  this->path = path;
+  worldHeader = header;
+  readerID = chunks->RegisterReader();
+
+  if (!std::ifstream(this->path, std::ios::binary)) {
+    WriteHeader();
+  }
+
+  isRunning = true;
+  worker = std::thread(&Autosave::WorkerLoop, this);
+}
+
+// Writes the remaining dirty chunks before stopping, the store must be
+// committed.
+void Autosave::Stop() {
+  if (worker.joinable()) {
+    WaitIdle();
+    Trigger();
+  }
+  {
+    std::lock_guard<std::mutex> lock(jobMutex);
+    isRunning = false;
+  }
+  jobCV.notify_all();
+  if (worker.joinable()) {
+    worker.join();
+  }
+}
+
+void Autosave::Update(float deltaTime) {
+  timer += deltaTime;
+  if (timer >= conf::AUTOSAVE_PERIOD && Trigger()) {
+    timer = 0.0f;
+  }
+}
+
+bool Autosave::Trigger() {
+  if (!worker.joinable()) {
+    return false;
+  }
+  {
+    std::lock_guard<std::mutex> lock(jobMutex);
+    if (isBusy) {
+      return false;
+    }
+  }
+
+  auto start = std::chrono::high_resolution_clock::now();
+  chunks->TakeDirtySlots(takenSlots);
+  if (takenSlots.empty()) {
+    snapshotTime = 0.0;
+    return true;
+  }
+
+  // Pin the committed snapshot, its chunks stay alive until the writer
+  // releases it.
+  const WorldSnapshot *snap = chunks->AcquireSnapshot(readerID);
+  {
+    std::lock_guard<std::mutex> lock(jobMutex);
+    jobSnapshot = snap;
+    jobSlots.swap(takenSlots);
+    isBusy = true;
+  }
+  jobCV.notify_all();
+
+  std::chrono::duration<double, std::micro> elapsed =
+      std::chrono::high_resolution_clock::now() - start;
+  snapshotTime = elapsed.count();
+  return true;
+}
+
+void Autosave::Reset() {
+  WaitIdle();
+  if (chunks != nullptr) {
+    chunks->TakeDirtySlots(takenSlots);
+  }
+  timer = 0.0f;
+  WriteHeader();
+}
+
+int Autosave::Replay() {
+  if (chunks == nullptr) {
+    return 0;
+  }
+  WaitIdle();
+  std::ifstream in(path, std::ios::binary);
+  SaveHeader header;
+  SaveWorldHeader world;
+  in.read((char *)&header, sizeof(header));
+  in.read((char *)&world, sizeof(world));
+  if (!in || std::memcmp(header.magic, JOURNAL_MAGIC, sizeof(header.magic)) ||
+      header.version != SAVE_VERSION ||
+      std::memcmp(&world, &worldHeader, sizeof(world)) != 0) {
+    Reset();
+    return 0;
+  }
+
+  int applied = chunks->ReplayJournal(in);
+  // Replayed chunks are already in the journal
+  chunks->TakeDirtySlots(takenSlots);
+  return applied;
+}
+
+// --- Getters ---
+double Autosave::GetSnapshotTime() const { return snapshotTime; }
+double Autosave::GetWriteTime() const { return writeTime; }
+size_t Autosave::GetBytesWritten() const { return bytesWritten; }
+
+// --- Private Methods ---
+void Autosave::WorkerLoop() {
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(jobMutex);
+      jobCV.wait(lock, [this] { return isBusy || !isRunning; });
+      // Finish a pending job before shutting down
+      if (!isBusy) {
+        return;
+      }
+    }
+    WriteJob();
+    {
+      std::lock_guard<std::mutex> lock(jobMutex);
+      isBusy = false;
+    }
+    jobCV.notify_all();
+  }
+}
+
+void Autosave::WriteJob() {
+  auto start = std::chrono::high_resolution_clock::now();
+
+  std::ofstream out(path, std::ios::binary | std::ios::app);
+  size_t bytes = 0;
+  for (int slot : jobSlots) {
+    int cq, cr;
+    jobSnapshot->layout.Coords(slot, cq, cr);
+    bytes += codec::WriteBlock(out, cq, cr, jobSnapshot->chunks[slot], false,
+                               buffers);
+  }
+  out.flush();
+  chunks->ReleaseSnapshot(readerID);
+
+  std::chrono::duration<double, std::milli> elapsed =
+      std::chrono::high_resolution_clock::now() - start;
+  writeTime = elapsed.count();
+  bytesWritten = bytes;
+}
+
+bool Autosave::WriteHeader() {
+  if (path.empty()) {
+    return false;
+  }
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  SaveHeader header = {};
+  std::memcpy(header.magic, JOURNAL_MAGIC, sizeof(header.magic));
+  header.version = SAVE_VERSION;
+  out.write((const char *)&header, sizeof(header));
+  out.write((const char *)&worldHeader, sizeof(worldHeader));
+  return out.good();
+}
+
+void Autosave::WaitIdle() {
+  std::unique_lock<std::mutex> lock(jobMutex);
+  jobCV.wait(lock, [this] { return !isBusy; });
+}
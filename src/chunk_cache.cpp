@@ -0,0 +1,132 @@
+#include "chunk_cache.h"
+#include "defines.h"
+#include "save_format.h"
+#include <iostream>
+
+// --- Constructors ---
+ChunkCache::ChunkCache() {
+  fileEnd = 0;
+  writePos = 0;
+}
+
+// --- Core Lifecycle ---
+bool ChunkCache::Open(const char *path, int slots) {
+  Close();
+  this->path = path;
+  stream.open(path, std::ios::binary | std::ios::in | std::ios::out |
+                        std::ios::trunc);
+  if (!stream) {
+    std::cout << "Error opening chunk cache " << path << std::endl;
+    return false;
+  }
+  extents.assign(slots, Extent{0, 0});
+  fileEnd = 0;
+  writePos = 0;
+  return true;
+}
+
+void ChunkCache::Close() {
+  if (stream.is_open()) {
+    stream.close();
+  }
+  extents.clear();
+  fileEnd = 0;
+}
+
+void ChunkCache::Reset() {
+  if (!stream.is_open()) {
+    return;
+  }
+  int slots = (int)extents.size();
+  std::string reopenPath = path;
+  Open(reopenPath.c_str(), slots);
+}
+
+// --- Blocks ---
+bool ChunkCache::Write(int slot, const SaveChunkHeader &header,
+                       const std::vector<u8> &packed) {
+  if (!stream.is_open()) {
+    return false;
+  }
+  if (slot >= (int)extents.size()) {
+    extents.resize(slot + 1, Extent{0, 0});
+  }
+  u32 size = (u32)(sizeof(header) + header.packedSize);
+  Extent &e = extents[slot];
+  if (size > e.capacity) {
+    e.offset = fileEnd;
+    e.capacity = size;
+    fileEnd += size;
+  }
+
+  if (writePos != e.offset) {
+    stream.clear();
+    stream.seekp((std::streamoff)e.offset);
+  }
+  writePos = e.offset + size;
+  stream.write((const char *)&header, sizeof(header));
+  stream.write((const char *)packed.data(), header.packedSize);
+  if (!stream) {
+    std::cout << "Error writing chunk cache " << path << std::endl;
+    e.capacity = 0;
+    return false;
+  }
+  return true;
+}
+
+bool ChunkCache::Read(int slot, SaveChunkHeader &header,
+                      std::vector<u8> &packed) {
+  if (!stream.is_open() || slot >= (int)extents.size()) {
+    return false;
+  }
+  const Extent &e = extents[slot];
+  if (e.capacity == 0) {
+    return false;
+  }
+  stream.clear();
+  stream.seekg((std::streamoff)e.offset);
+  writePos = ~0ULL; // Shared position moved
+  stream.read((char *)&header, sizeof(header));
+  if (!stream || sizeof(header) + header.packedSize > e.capacity) {
+    return false;
+  }
+  packed.resize(header.packedSize);
+  stream.read((char *)packed.data(), header.packedSize);
+  return (bool)stream;
+}
+
+void ChunkCache::Flush() {
+  if (stream.is_open()) {
+    stream.flush();
+  }
+}
+
+// Reads through its own handle, Flush() after writing.
+size_t ChunkCache::CopyBlock(int slot, std::ostream &out) const {
+  if (slot >= (int)extents.size()) {
+    return 0;
+  }
+  const Extent &e = extents[slot];
+  if (e.capacity == 0) {
+    return 0;
+  }
+  std::ifstream in(path, std::ios::binary);
+  in.seekg((std::streamoff)e.offset);
+  SaveChunkHeader header;
+  in.read((char *)&header, sizeof(header));
+  if (!in || sizeof(header) + header.packedSize > e.capacity) {
+    return 0;
+  }
+  std::vector<char> packed(header.packedSize);
+  in.read(packed.data(), packed.size());
+  if (!in) {
+    return 0;
+  }
+  out.write((const char *)&header, sizeof(header));
+  out.write(packed.data(), packed.size());
+  return sizeof(header) + packed.size();
+}
+
+// --- Getters ---
+bool ChunkCache::IsOpen() const { return stream.is_open(); }
+u64 ChunkCache::GetFileSize() const { return fileEnd; }
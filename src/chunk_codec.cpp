@@ -0,0 +1,219 @@
+#include "chunk_codec.h"
+#include "chunk_store.h"
+#include "defines.h"
+#include "map_tile.h"
+#include "save_format.h"
+#include <algorithm>
+#include <istream>
+#include <ostream>
+
+namespace {
+constexpr int MIN_RUN = 3;
+constexpr int MAX_RUN = 127 + MIN_RUN;
+constexpr int MAX_LITERAL = 128;
+
+// Largest valid chunk: every tile edited
+constexpr u32 MAX_RAW_SIZE = 2 + chunk::TILES * 5;
+
+// Sparse chunks hold their edits sorted already, skip the tile scan
+template <typename AddFunc>
+void ForEachTile(const chunk::SparseChunk &c, AddFunc add) {
+  for (const chunk::TileEdit &e : c.edits) {
+    add(e.index, e.id, e.rsrc);
+  }
+}
+
+template <typename AddFunc>
+void ForEachTile(const chunk::DenseChunk &c, AddFunc add) {
+  for (int i = 0; i < chunk::TILES; i++) {
+    add(i, c.GetID(i), c.GetResource(i));
+  }
+}
+} // namespace
+
+namespace codec {
+
+// --- Chunk ---
+int EncodeChunk(const chunk::Chunk &c, std::vector<u8> &out) {
+  std::vector<u16> index;
+  std::vector<u8> id;
+  std::vector<pack::Resource> rsrc;
+  auto add = [&](int i, u8 tileID, pack::Resource bits) {
+    if (tileID != chunk::BASE_ID || bits != pack::RESOURCE_PRISTINE) {
+      index.push_back((u16)i);
+      id.push_back(tileID);
+      rsrc.push_back(bits);
+    }
+  };
+  ForEachTile(c, add);
+
+  int count = (int)index.size();
+  out.clear();
+  out.reserve(2 + count * 5);
+  out.push_back((u8)count);
+  out.push_back((u8)(count >> 8));
+
+  u16 prev = 0;
+  for (int i = 0; i < count; i++) {
+    out.push_back((u8)(index[i] - prev));
+    prev = index[i];
+  }
+  prev = 0;
+  for (int i = 0; i < count; i++) {
+    out.push_back((u8)((index[i] - prev) >> 8));
+    prev = index[i];
+  }
+  out.insert(out.end(), id.begin(), id.end());
+  for (pack::Resource bits : rsrc) {
+    out.push_back((u8)bits);
+  }
+  for (pack::Resource bits : rsrc) {
+    out.push_back((u8)(bits >> 8));
+  }
+  return count;
+}
+
+bool DecodeChunk(const u8 *data, size_t size, chunk::Chunk &c) {
+  if (size < 2) {
+    return false;
+  }
+  int count = data[0] | data[1] << 8;
+  if (count > chunk::TILES || size != 2 + (size_t)count * 5) {
+    return false;
+  }
+
+  const u8 *deltaLo = data + 2;
+  const u8 *deltaHi = deltaLo + count;
+  const u8 *id = deltaHi + count;
+  const u8 *rsrcLo = id + count;
+  const u8 *rsrcHi = rsrcLo + count;
+
+  int index = 0;
+  for (int i = 0; i < count; i++) {
+    index += deltaLo[i] | deltaHi[i] << 8;
+    if (index >= chunk::TILES) {
+      return false;
+    }
+    c.SetID(index, id[i]);
+    c.SetResource(index, (pack::Resource)(rsrcLo[i] | rsrcHi[i] << 8));
+  }
+  return true;
+}
+
+// --- Run-Length Coding ---
+void Compress(const u8 *data, size_t size, std::vector<u8> &out) {
+  out.clear();
+  size_t i = 0;
+  size_t literalStart = 0;
+
+  auto flushLiterals = [&](size_t end) {
+    while (literalStart < end) {
+      size_t n = std::min(end - literalStart, (size_t)MAX_LITERAL);
+      out.push_back((u8)(n - 1));
+      out.insert(out.end(), data + literalStart, data + literalStart + n);
+      literalStart += n;
+    }
+  };
+
+  while (i < size) {
+    size_t run = 1;
+    while (i + run < size && run < MAX_RUN && data[i + run] == data[i]) {
+      run++;
+    }
+    if (run >= MIN_RUN) {
+      flushLiterals(i);
+      out.push_back((u8)(128 + run - MIN_RUN));
+      out.push_back(data[i]);
+      i += run;
+      literalStart = i;
+    } else {
+      i += run;
+    }
+  }
+  flushLiterals(size);
+}
+
+bool Decompress(const u8 *data, size_t size, size_t rawSize,
+                std::vector<u8> &out) {
+  out.clear();
+  out.reserve(rawSize);
+  size_t i = 0;
+  while (i < size) {
+    u8 control = data[i++];
+    if (control < 128) {
+      size_t n = control + 1;
+      if (i + n > size || out.size() + n > rawSize) {
+        return false;
+      }
+      out.insert(out.end(), data + i, data + i + n);
+      i += n;
+    } else {
+      size_t n = control - 128 + MIN_RUN;
+      if (i >= size || out.size() + n > rawSize) {
+        return false;
+      }
+      out.insert(out.end(), n, data[i++]);
+    }
+  }
+  return out.size() == rawSize;
+}
+
+// --- Blocks ---
+size_t WriteBlock(std::ostream &out, int cq, int cr, const chunk::Chunk *c,
+                  bool skipPristine, Buffers &buf) {
+  SaveChunkHeader header = {cq, cr, 0, 0};
+  if (c != nullptr && EncodeChunk(*c, buf.raw) > 0) {
+    Compress(buf.raw.data(), buf.raw.size(), buf.packed);
+    header.rawSize = (u32)buf.raw.size();
+    header.packedSize = (u32)buf.packed.size();
+  } else if (skipPristine) {
+    return 0;
+  }
+
+  out.write((const char *)&header, sizeof(header));
+  out.write((const char *)buf.packed.data(), header.packedSize);
+  return sizeof(header) + header.packedSize;
+}
+
+bool ReadPackedBlock(std::istream &in, SaveChunkHeader &header,
+                     std::vector<u8> &packed) {
+  in.read((char *)&header, sizeof(header));
+  if (!in || header.rawSize > MAX_RAW_SIZE ||
+      header.packedSize > 2 * MAX_RAW_SIZE) {
+    return false;
+  }
+  if (header.rawSize == 0) {
+    packed.clear();
+    return header.packedSize == 0;
+  }
+  packed.resize(header.packedSize);
+  in.read((char *)packed.data(), header.packedSize);
+  return (bool)in;
+}
+
+bool ReadBlock(std::istream &in, Buffers &buf, int &cq, int &cr,
+               chunk::Chunk *&c) {
+  c = nullptr;
+  SaveChunkHeader header;
+  if (!ReadPackedBlock(in, header, buf.packed)) {
+    return false;
+  }
+  cq = header.cq;
+  cr = header.cr;
+  if (header.rawSize == 0) {
+    return true;
+  }
+  if (!Decompress(buf.packed.data(), buf.packed.size(), header.rawSize,
+                  buf.raw)) {
+    return false;
+  }
+
+  c = new chunk::Chunk;
+  if (!DecodeChunk(buf.raw.data(), buf.raw.size(), *c)) {
+    delete c;
+    c = nullptr;
+    return false;
+  }
+  return true;
+}
+} // namespace codec
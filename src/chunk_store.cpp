@@ -0,0 +1,981 @@
+#include "chunk_store.h"
+#include "chunk_cache.h"
+#include "chunk_codec.h"
+#include "defines.h"
+#include "map_tile.h"
+#include "parallel.h"
+#include "save_format.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// ============= Chunks ====================
+
+// --- Dense Chunk ---
+chunk::DenseChunk::DenseChunk() {
+  std::memset(ids, BASE_ID, sizeof(ids));
+  std::memset(rsrc, 0, sizeof(rsrc)); // pack::RESOURCE_PRISTINE
+  generation = 0;
+}
+
+u8 chunk::DenseChunk::GetID(int i) const { return ids[i]; }
+pack::Resource chunk::DenseChunk::GetResource(int i) const { return rsrc[i]; }
+void chunk::DenseChunk::SetID(int i, u8 id) { ids[i] = id; }
+void chunk::DenseChunk::SetResource(int i, pack::Resource rsrc) {
+  this->rsrc[i] = rsrc;
+}
+size_t chunk::DenseChunk::GetBytes() const { return sizeof(DenseChunk); }
+
+// --- Sparse Chunk ---
+static bool EditBefore(const chunk::TileEdit &e, int i) { return e.index < i; }
+
+chunk::SparseChunk::SparseChunk() { generation = 0; }
+
+u8 chunk::SparseChunk::GetID(int i) const {
+  auto it = std::lower_bound(edits.begin(), edits.end(), i, EditBefore);
+  return (it != edits.end() && it->index == i) ? it->id : BASE_ID;
+}
+
+pack::Resource chunk::SparseChunk::GetResource(int i) const {
+  auto it = std::lower_bound(edits.begin(), edits.end(), i, EditBefore);
+  return (it != edits.end() && it->index == i) ? it->rsrc
+                                               : pack::RESOURCE_PRISTINE;
+}
+
+void chunk::SparseChunk::SetID(int i, u8 id) { Acquire(i).id = id; }
+
+void chunk::SparseChunk::SetResource(int i, pack::Resource rsrc) {
+  Acquire(i).rsrc = rsrc;
+}
+
+size_t chunk::SparseChunk::GetBytes() const {
+  return sizeof(SparseChunk) + edits.capacity() * sizeof(TileEdit);
+}
+
+chunk::TileEdit &chunk::SparseChunk::Acquire(int i) {
+  auto it = std::lower_bound(edits.begin(), edits.end(), i, EditBefore);
+  if (it == edits.end() || it->index != i) {
+    it = edits.insert(it, {(u16)i, BASE_ID, pack::RESOURCE_PRISTINE});
+  }
+  return *it;
+}
+
+// ============= Tile Order ====================
+// Inverse of SpreadBits.
+static int CompactBits(int v) {
+  v &= 0x5555;
+  v = (v | (v >> 1)) & 0x3333;
+  v = (v | (v >> 2)) & 0x0f0f;
+  return (v | (v >> 4)) & 0x00ff;
+}
+
+int chunk::TileIndex(int lq, int lr) {
+  if (TILE_ORDER == MORTON) {
+    return MortonIndex(lq, lr);
+  }
+  return lr * SIZE + lq;
+}
+
+void chunk::TileCoords(int i, int &lq, int &lr) {
+  if (TILE_ORDER == MORTON) {
+    lq = CompactBits(i);
+    lr = CompactBits(i >> 1);
+    return;
+  }
+  lq = i & MASK;
+  lr = i >> SHIFT;
+}
+
+// ============= Chunk Layout ====================
+void chunk::Layout::Init(int mapRadius) {
+  this->mapRadius = mapRadius;
+  regions = nullptr;
+  if (IsUnbounded()) {
+    rowOffset.clear();
+    rowFirst.clear();
+    slots = 0;
+    return;
+  }
+  int rows = (mapRadius * 2 + SIZE) >> SHIFT;
+  rowOffset.assign(rows, 0);
+  rowFirst.assign(rows, 0);
+  slots = 0;
+
+  for (int cr = 0; cr < rows; cr++) {
+    int rLo = std::max((cr << SHIFT) - mapRadius, -mapRadius);
+    int rHi = std::min((cr << SHIFT) + MASK - mapRadius, mapRadius);
+
+    // Union of the rows' q spans, |q| <= R and |q + r| <= R
+    int qLo = std::max(-mapRadius, -mapRadius - rHi);
+    int qHi = std::min(mapRadius, mapRadius - rLo);
+
+    rowOffset[cr] = slots;
+    rowFirst[cr] = (qLo + mapRadius) >> SHIFT;
+    slots += ((qHi + mapRadius) >> SHIFT) - rowFirst[cr] + 1;
+  }
+}
+
+bool chunk::Layout::IsUnbounded() const { return mapRadius == 0; }
+
+// Right shifts floor negative coordinates.
+int chunk::Layout::Index(int q, int r) const {
+  int cq = (q + mapRadius) >> SHIFT;
+  int cr = (r + mapRadius) >> SHIFT;
+  return Slot(cq, cr);
+}
+
+int chunk::Layout::Slot(int cq, int cr) const {
+  if (IsUnbounded()) {
+    const int *first = regions->firstSlot.Find(
+        HexCoord(cq >> REGION_SHIFT, cr >> REGION_SHIFT));
+    if (first == nullptr) {
+      return NO_SLOT;
+    }
+    return *first + (cr & REGION_MASK) * REGION_SIZE + (cq & REGION_MASK);
+  }
+
+  if (cr < 0 || cr >= (int)rowOffset.size() || cq < rowFirst[cr]) {
+    return NO_SLOT;
+  }
+  int slot = rowOffset[cr] + cq - rowFirst[cr];
+  int rowEnd = cr + 1 < (int)rowOffset.size() ? rowOffset[cr + 1] : slots;
+  return slot < rowEnd ? slot : NO_SLOT;
+}
+
+void chunk::Layout::Coords(int slot, int &cq, int &cr) const {
+  if (IsUnbounded()) {
+    HexCoord region = regions->coords[slot / REGION_SLOTS];
+    int local = slot % REGION_SLOTS;
+    cq = region.q * REGION_SIZE + (local & REGION_MASK);
+    cr = region.r * REGION_SIZE + (local >> REGION_SHIFT);
+    return;
+  }
+  cr = (int)(std::upper_bound(rowOffset.begin(), rowOffset.end(), slot) -
+             rowOffset.begin()) -
+       1;
+  cq = slot - rowOffset[cr] + rowFirst[cr];
+}
+
+// ============= World Snapshot ====================
+const chunk::Chunk *WorldSnapshot::Find(int q, int r) const {
+  int slot = layout.Index(q, r);
+  return slot != chunk::NO_SLOT ? chunks[slot] : nullptr;
+}
+
+// ============= Chunk Store ====================
+
+// --- Constructors ---
+ChunkStore::ChunkStore() {
+  published = nullptr;
+  epoch = 1;
+  for (std::atomic<u64> &e : readerEpochs) {
+    e = 0;
+  }
+  readerCount = 0;
+  generation = 0;
+  isDirty = false;
+  regions = nullptr;
+  isRegionsShared = false;
+  mapRadius = 0;
+  chunksLoaded = 0;
+  chunksEvicted = 0;
+  chunksPacked = 0;
+  packedBytes = 0;
+  touchClock = 1;
+  evictCount = 0;
+  reloadCount = 0;
+  evictTime = 0.0;
+  reloadTime = 0.0;
+  packRate = 0.0;
+  unpackRate = 0.0;
+}
+
+ChunkStore::~ChunkStore() { Clear(); }
+
+// --- Core Lifecycle ---
+void ChunkStore::Init(int mapRadius) {
+  Clear();
+  this->mapRadius = mapRadius;
+
+  layout.Init(mapRadius);
+  if (layout.IsUnbounded()) {
+    regions = new chunk::Regions;
+    layout.regions = regions;
+  }
+  GrowSlots();
+
+  // Publish the empty directory so readers always find a snapshot.
+  isDirty = true;
+  Commit();
+}
+
+// Must not race with readers, shut them down first.
+void ChunkStore::Clear() {
+  for (chunk::Chunk *c : live) {
+    FreeChunk(c);
+  }
+  for (const chunk::Chunk *c : replaced) {
+    FreeChunk(c);
+  }
+  for (const Retired &r : retired) {
+    FreeChunk(r.chunk);
+    delete r.snapshot;
+    delete r.regions;
+  }
+  for (const chunk::Regions *r : replacedRegions) {
+    delete r;
+  }
+  delete published.exchange(nullptr);
+  delete regions;
+  regions = nullptr;
+  layout.regions = nullptr;
+  for (int slot = 0; slot < (int)packed.size(); slot++) {
+    FreePacked(slot);
+  }
+  file.Close();
+  cache.Close();
+
+  live.clear();
+  replaced.clear();
+  replacedRegions.clear();
+  retired.clear();
+  isSlotDirty.clear();
+  dirtySlots.clear();
+  residency.clear();
+  packed.clear();
+  lastTouched.clear();
+  chunksLoaded = 0;
+  chunksEvicted = 0;
+  chunksPacked = 0;
+  packedBytes = 0;
+  isDirty = false;
+}
+
+void ChunkStore::Commit() {
+  if (!isDirty) {
+    return;
+  }
+
+  WorldSnapshot *next = new WorldSnapshot;
+  next->chunks.assign(live.begin(), live.end());
+  next->generation = ++generation;
+  next->layout = layout;
+
+  // Readers entering after the epoch bump can only see 'next', so everything
+  // replaced so far is retired in the epoch before it.
+  const WorldSnapshot *prev = published.exchange(next);
+  u64 retireEpoch = epoch.fetch_add(1);
+
+  if (prev != nullptr) {
+    retired.push_back({retireEpoch, nullptr, prev, nullptr});
+  }
+  for (const chunk::Chunk *c : replaced) {
+    retired.push_back({retireEpoch, c, nullptr, nullptr});
+  }
+  for (const chunk::Regions *r : replacedRegions) {
+    retired.push_back({retireEpoch, nullptr, nullptr, r});
+  }
+  replaced.clear();
+  replacedRegions.clear();
+  isRegionsShared = true;
+  isDirty = false;
+
+  Reclaim();
+}
+
+// --- Chunk Access (logic thread) ---
+const chunk::Chunk *ChunkStore::Find(int q, int r) const {
+  int index = layout.Index(q, r);
+  if (index == chunk::NO_SLOT) {
+    return nullptr;
+  }
+  if (residency[index] != chunk::RESIDENT) {
+    // Restoring does not change what the slot reads as
+    const_cast<ChunkStore *>(this)->Restore(index);
+  }
+  return live[index];
+}
+
+chunk::Chunk *ChunkStore::Edit(int q, int r) {
+  int index = layout.Index(q, r);
+  if (index == chunk::NO_SLOT) {
+    return nullptr;
+  }
+  // A cold copy that cannot be restored stays as it is, never edit around it
+  if (residency[index] != chunk::RESIDENT && !Restore(index)) {
+    return nullptr;
+  }
+  lastTouched[index] = touchClock;
+  chunk::Chunk *&slot = live[index];
+  if (slot == nullptr) {
+    return nullptr;
+  }
+  MarkDirty(index);
+
+  // Already copied (or created) since the last commit. File records are
+  // always shared.
+  if (!file.Contains(slot) && slot->generation > generation) {
+    return slot;
+  }
+
+  chunk::Chunk *copy = new chunk::Chunk(*slot);
+  copy->generation = generation + 1;
+  replaced.push_back(slot);
+  slot = copy;
+  isDirty = true;
+  return copy;
+}
+
+bool ChunkStore::Publish(int q, int r, chunk::Chunk *c) {
+  int slot = AcquireSlot(ChunkCoord(q), ChunkCoord(r));
+  if (residency[slot] != chunk::RESIDENT && !Restore(slot)) {
+    delete c;
+    return false;
+  }
+  PublishSlot(slot, c);
+  return true;
+}
+
+int ChunkStore::AcquireSlot(int cq, int cr) {
+  int slot = layout.Slot(cq, cr);
+  if (slot != chunk::NO_SLOT || !layout.IsUnbounded()) {
+    return slot;
+  }
+
+  // Snapshots may still look regions up in the published table, it is
+  // copied once per Commit()
+  if (isRegionsShared) {
+    replacedRegions.push_back(regions);
+    regions = new chunk::Regions(*regions);
+    layout.regions = regions;
+    isRegionsShared = false;
+  }
+  HexCoord region(cq >> chunk::REGION_SHIFT, cr >> chunk::REGION_SHIFT);
+  regions->firstSlot[region] = layout.slots;
+  regions->coords.push_back(region);
+  layout.slots += chunk::REGION_SLOTS;
+  GrowSlots();
+  isDirty = true;
+  return layout.Slot(cq, cr);
+}
+
+// --- World File ---
+bool ChunkStore::MapFile(const char *path, u64 seed) {
+  if constexpr (!std::is_same_v<chunk::Chunk, chunk::DenseChunk>) {
+    std::cout << "World files need dense tile storage" << std::endl;
+    return false;
+  } else {
+    if (layout.IsUnbounded()) {
+      std::cout << "World files need a bounded world" << std::endl;
+      return false;
+    }
+    WorldFileHeader header = {};
+    std::memcpy(header.magic, WORLD_FILE_MAGIC, sizeof(header.magic));
+    header.version = WORLD_FILE_VERSION;
+    header.chunkShift = chunk::SHIFT;
+    header.tileOrder = chunk::TILE_ORDER;
+    header.mapRadius = mapRadius;
+    header.seed = seed;
+    header.slots = layout.slots;
+    header.recordSize = sizeof(chunk::Chunk);
+    if (!file.Open(path, header)) {
+      return false;
+    }
+
+    // Only the used table is read, records are paged in on first access
+    for (int slot = 0; slot < layout.slots; slot++) {
+      if (file.IsUsed(slot)) {
+        live[slot] = (chunk::Chunk *)file.Record(slot);
+        chunksLoaded++;
+      }
+    }
+    isDirty = true;
+    Commit();
+    return true;
+  }
+}
+
+void ChunkStore::Flush() {
+  if (!file.IsOpen()) {
+    return;
+  }
+  for (int slot = 0; slot < layout.slots; slot++) {
+    chunk::Chunk *c = live[slot];
+    if (c == nullptr || file.Contains(c)) {
+      continue;
+    }
+    chunk::Chunk *record = (chunk::Chunk *)file.Record(slot);
+    std::memcpy((void *)record, c, sizeof(chunk::Chunk));
+    file.MarkUsed(slot);
+
+    // Continue on the record, the heap copy retires like any replaced chunk
+    replaced.push_back(c);
+    live[slot] = record;
+    isDirty = true;
+  }
+  Commit();
+  file.Sync();
+}
+
+// --- Save / Load (logic thread) ---
+bool ChunkStore::Save(std::ostream &out) const {
+  // Chunk count is patched in once the pristine chunks are skipped
+  std::streampos countPos = out.tellp();
+  u32 count = 0;
+  out.write((const char *)&count, sizeof(count));
+
+  codec::Buffers buf;
+  for (int slot = 0; slot < layout.slots; slot++) {
+    const chunk::Chunk *c = live[slot];
+    int cq, cr;
+    layout.Coords(slot, cq, cr);
+    if (c != nullptr && codec::WriteBlock(out, cq, cr, c, true, buf) > 0) {
+      count++;
+    }
+    // Cold blocks already have the save layout
+    if (residency[slot] == chunk::PACKED) {
+      const chunk::PackedChunk *p = packed[slot];
+      out.write((const char *)&p->header, sizeof(p->header));
+      out.write((const char *)p->data.data(), p->data.size());
+      count++;
+    }
+    if (residency[slot] == chunk::EVICTED && cache.CopyBlock(slot, out) > 0) {
+      count++;
+    }
+  }
+
+  std::streampos endPos = out.tellp();
+  out.seekp(countPos);
+  out.write((const char *)&count, sizeof(count));
+  out.seekp(endPos);
+  return out.good();
+}
+
+// Every block is decoded once on all cores, so applying the blocks cannot
+// fail halfway.
+bool ChunkStore::ReadSave(std::istream &in,
+                          std::vector<chunk::PackedChunk> &blocks) const {
+  blocks.clear();
+  u32 count = 0;
+  in.read((char *)&count, sizeof(count));
+  if (!in || (!layout.IsUnbounded() && count > (u32)layout.slots)) {
+    return false;
+  }
+
+  chunk::PackedChunk block;
+  for (u32 n = 0; n < count; n++) {
+    if (!codec::ReadPackedBlock(in, block.header, block.data)) {
+      return false;
+    }
+    if (!layout.IsUnbounded() &&
+        layout.Slot(block.header.cq, block.header.cr) == chunk::NO_SLOT) {
+      return false;
+    }
+    // Empty blocks read as the base world, which Discard() leaves behind
+    if (block.header.rawSize != 0) {
+      blocks.push_back(block);
+    }
+  }
+
+  std::vector<u8> isBroken(blocks.size(), 0);
+  std::vector<std::vector<u8>> raw(parallel::GetWorkerCount());
+  parallel::For((int)blocks.size(), [&](int i, int worker) {
+    chunk::Chunk *c = DecodeBlock(blocks[i].header, blocks[i].data,
+                                  raw[worker]);
+    isBroken[i] = c == nullptr;
+    delete c;
+  });
+  return std::find(isBroken.begin(), isBroken.end(), 1) == isBroken.end();
+}
+
+void ChunkStore::ApplySave(std::vector<chunk::PackedChunk> &blocks) {
+  Discard();
+
+  // Mapped chunks live in the file, they are decoded into it right away
+  if (file.IsOpen()) {
+    for (const chunk::PackedChunk &b : blocks) {
+      int slot = AcquireSlot(b.header.cq, b.header.cr);
+      PublishSlot(slot, DecodeBlock(b.header, b.data, cacheRaw));
+    }
+    Commit();
+    return;
+  }
+
+  for (chunk::PackedChunk &b : blocks) {
+    int slot = AcquireSlot(b.header.cq, b.header.cr);
+    DropCold(slot);
+    packedBytes += b.data.size();
+    packed[slot] = new chunk::PackedChunk{b.header, std::move(b.data)};
+    residency[slot] = chunk::PACKED;
+    chunksPacked++;
+  }
+  Commit();
+}
+
+// Blocks are applied in order until the end of the stream. A torn block at
+// the end (crash during a write) is ignored.
+int ChunkStore::ReplayJournal(std::istream &in) {
+  codec::Buffers buf;
+  int applied = 0;
+  int cq, cr;
+  chunk::Chunk *c;
+  while (in.peek() != std::char_traits<char>::eof() &&
+         codec::ReadBlock(in, buf, cq, cr, c)) {
+    int slot = AcquireSlot(cq, cr);
+    if (slot == chunk::NO_SLOT) {
+      delete c;
+      break;
+    }
+    if (c != nullptr) {
+      PublishSlot(slot, c);
+    } else {
+      DropSlot(slot);
+    }
+    applied++;
+  }
+  Commit();
+  return applied;
+}
+
+void ChunkStore::Discard() {
+  for (int slot = 0; slot < layout.slots; slot++) {
+    DropSlot(slot);
+  }
+  cache.Reset();
+}
+
+// --- Chunk Cache (logic thread) ---
+bool ChunkStore::OpenCache(const char *path) {
+  if (file.IsOpen()) {
+    return false;
+  }
+  return cache.Open(path, layout.slots);
+}
+
+void ChunkStore::Touch(int slot) {
+  if (residency[slot] != chunk::RESIDENT) {
+    Restore(slot);
+  }
+  lastTouched[slot] = touchClock;
+}
+
+void ChunkStore::Prefetch(const std::vector<int> &slots) {
+  std::vector<int> cold;
+  for (int slot : slots) {
+    if (residency[slot] == chunk::PACKED) {
+      cold.push_back(slot);
+    } else {
+      Touch(slot);
+    }
+  }
+
+  // Packed blocks are immutable, workers only read them
+  std::vector<chunk::Chunk *> decoded(cold.size());
+  std::vector<std::vector<u8>> raw(parallel::GetWorkerCount());
+  parallel::For((int)cold.size(), [&](int i, int worker) {
+    const chunk::PackedChunk *p = packed[cold[i]];
+    decoded[i] = DecodeBlock(p->header, p->data, raw[worker]);
+  });
+
+  for (size_t i = 0; i < cold.size(); i++) {
+    int slot = cold[i];
+    // A block that fails to decode stays packed, as in Unpack()
+    if (decoded[i] == nullptr) {
+      std::cout << "Error unpacking chunk " << slot << std::endl;
+      continue;
+    }
+    FreePacked(slot);
+    residency[slot] = chunk::RESIDENT;
+    Install(slot, decoded[i]);
+  }
+}
+
+void ChunkStore::PackCold(u32 minAge, std::vector<int> &out) {
+  if (file.IsOpen()) {
+    return;
+  }
+  size_t first = out.size();
+  for (int slot = 0; slot < layout.slots; slot++) {
+    if ((int)(out.size() - first) >= conf::CHUNK_PACK_MAX) {
+      break;
+    }
+    if (live[slot] != nullptr && !isSlotDirty[slot] &&
+        touchClock - lastTouched[slot] >= minAge) {
+      out.push_back(slot);
+    }
+  }
+  if (out.size() == first) {
+    return;
+  }
+
+  auto start = std::chrono::high_resolution_clock::now();
+  size_t rawBytes = 0;
+  for (size_t i = first; i < out.size(); i++) {
+    rawBytes += Pack(out[i]);
+  }
+  std::chrono::duration<double, std::micro> elapsed =
+      std::chrono::high_resolution_clock::now() - start;
+  packRate = rawBytes / std::max(elapsed.count(), 1e-3);
+}
+
+void ChunkStore::EvictToBudget(size_t budgetBytes, size_t targetBytes,
+                               std::vector<int> &out) {
+  u32 round = touchClock++;
+  if (!cache.IsOpen()) {
+    return;
+  }
+  size_t bytes = GetBytesInUse();
+  if (bytes <= budgetBytes) {
+    return;
+  }
+  auto start = std::chrono::high_resolution_clock::now();
+
+  // Least recently touched first, skip what was used this round
+  std::vector<int> candidates;
+  for (int slot = 0; slot < layout.slots; slot++) {
+    bool isHeld = live[slot] != nullptr || residency[slot] == chunk::PACKED;
+    if (isHeld && !isSlotDirty[slot] && lastTouched[slot] < round) {
+      candidates.push_back(slot);
+    }
+  }
+  std::sort(candidates.begin(), candidates.end(), [this](int a, int b) {
+    return lastTouched[a] < lastTouched[b];
+  });
+
+  // Capped per round to bound the hitch, the next round continues
+  int evicted = 0;
+  for (int slot : candidates) {
+    if (bytes <= targetBytes || evicted >= conf::CHUNK_EVICT_MAX) {
+      break;
+    }
+    size_t chunkBytes = live[slot] != nullptr ? live[slot]->GetBytes()
+                                              : packed[slot]->data.size();
+    if (!Evict(slot)) {
+      break;
+    }
+    bytes -= chunkBytes;
+    out.push_back(slot);
+    evicted++;
+  }
+  cache.Flush();
+
+  std::chrono::duration<double, std::micro> elapsed =
+      std::chrono::high_resolution_clock::now() - start;
+  evictTime = elapsed.count() / std::max(evicted, 1);
+}
+
+// --- Dirty Tracking (logic thread) ---
+void ChunkStore::TakeDirtySlots(std::vector<int> &out) {
+  out.clear();
+  out.swap(dirtySlots);
+  for (int slot : out) {
+    isSlotDirty[slot] = 0;
+  }
+}
+
+int ChunkStore::GetDirtyCount() const { return (int)dirtySlots.size(); }
+
+// --- Snapshots (any thread) ---
+int ChunkStore::RegisterReader() {
+  if (readerCount >= chunk::MAX_READERS) {
+    return -1;
+  }
+  return readerCount++;
+}
+
+const WorldSnapshot *ChunkStore::AcquireSnapshot(int readerID) {
+  readerEpochs[readerID].store(epoch.load());
+  return published.load();
+}
+
+void ChunkStore::ReleaseSnapshot(int readerID) {
+  readerEpochs[readerID].store(0, std::memory_order_release);
+}
+
+// --- Getters ---
+int ChunkStore::GetChunksLoaded() const { return chunksLoaded; }
+int ChunkStore::GetChunkSlots() const { return layout.slots; }
+u32 ChunkStore::GetGeneration() const { return generation; }
+int ChunkStore::GetChunksEvicted() const { return chunksEvicted; }
+int ChunkStore::GetChunksPacked() const { return chunksPacked; }
+size_t ChunkStore::GetPackedBytes() const { return packedBytes; }
+double ChunkStore::GetPackRate() const { return packRate; }
+double ChunkStore::GetUnpackRate() const { return unpackRate; }
+int ChunkStore::GetEvictCount() const { return evictCount; }
+int ChunkStore::GetReloadCount() const { return reloadCount; }
+double ChunkStore::GetEvictTime() const { return evictTime; }
+double ChunkStore::GetReloadTime() const { return reloadTime; }
+// Heap only, mapped records are owned by the page cache.
+size_t ChunkStore::GetBytesInUse() const {
+  size_t bytes = live.size() * sizeof(chunk::Chunk *);
+  for (const chunk::Chunk *c : live) {
+    if (c != nullptr && !file.Contains(c)) {
+      bytes += c->GetBytes();
+    }
+  }
+  for (const chunk::Chunk *c : replaced) {
+    bytes += c->GetBytes();
+  }
+  bytes += packed.size() * sizeof(chunk::PackedChunk *);
+  bytes += chunksPacked * sizeof(chunk::PackedChunk) + packedBytes;
+  return bytes;
+}
+
+// --- Conversions / Helpers ---
+int ChunkStore::LocalIndex(int q, int r) const {
+  int lq = (q + mapRadius) & chunk::MASK;
+  int lr = (r + mapRadius) & chunk::MASK;
+  return chunk::TileIndex(lq, lr);
+}
+
+int ChunkStore::SlotIndex(int q, int r) const { return layout.Index(q, r); }
+
+int ChunkStore::ChunkCoord(int coord) const {
+  return (coord + mapRadius) >> chunk::SHIFT;
+}
+
+int ChunkStore::ChunkOrigin(int chunkCoord) const {
+  return chunkCoord * chunk::SIZE - mapRadius;
+}
+
+// --- Private Methods ---
+void ChunkStore::Reclaim() {
+  // Oldest epoch a reader may still be looking at, 0 means idle
+  u64 oldest = std::numeric_limits<u64>::max();
+  for (int i = 0; i < readerCount; i++) {
+    u64 e = readerEpochs[i].load();
+    if (e != 0 && e < oldest) {
+      oldest = e;
+    }
+  }
+
+  size_t kept = 0;
+  for (const Retired &r : retired) {
+    if (r.epoch < oldest) {
+      FreeChunk(r.chunk);
+      delete r.snapshot;
+      delete r.regions;
+    } else {
+      retired[kept++] = r;
+    }
+  }
+  retired.resize(kept);
+}
+
+void ChunkStore::FreeChunk(const chunk::Chunk *c) {
+  if (!file.Contains(c)) {
+    delete c;
+  }
+}
+
+// Per-slot state follows the directory, unbounded worlds grow it by a
+// region at a time.
+void ChunkStore::GrowSlots() {
+  live.resize(layout.slots, nullptr);
+  isSlotDirty.resize(layout.slots, 0);
+  residency.resize(layout.slots, chunk::RESIDENT);
+  packed.resize(layout.slots, nullptr);
+  lastTouched.resize(layout.slots, 0);
+}
+
+void ChunkStore::PublishSlot(int slot, chunk::Chunk *c) {
+  MarkDirty(slot);
+  chunk::Chunk *&entry = live[slot];
+  if (entry != nullptr) {
+    replaced.push_back(entry);
+  } else {
+    chunksLoaded++;
+  }
+  DropCold(slot);
+  c->generation = generation + 1;
+  entry = c;
+  lastTouched[slot] = touchClock;
+  isDirty = true;
+}
+
+void ChunkStore::DropSlot(int slot) {
+  if (live[slot] != nullptr) {
+    MarkDirty(slot);
+    replaced.push_back(live[slot]);
+    live[slot] = nullptr;
+    chunksLoaded--;
+    isDirty = true;
+  }
+  if (DropCold(slot)) {
+    MarkDirty(slot);
+  }
+  if (file.IsOpen()) {
+    file.MarkFree(slot);
+  }
+}
+
+void ChunkStore::MarkDirty(int slot) {
+  if (!isSlotDirty[slot]) {
+    isSlotDirty[slot] = 1;
+    dirtySlots.push_back(slot);
+  }
+}
+
+// Encodes 'c' into cachePacked. False if the chunk is pristine.
+bool ChunkStore::EncodeBlock(int slot, const chunk::Chunk &c,
+                             SaveChunkHeader &header) {
+  if (codec::EncodeChunk(c, cacheRaw) == 0) {
+    return false;
+  }
+  codec::Compress(cacheRaw.data(), cacheRaw.size(), cachePacked);
+  int cq, cr;
+  layout.Coords(slot, cq, cr);
+  header = {cq, cr, (u32)cacheRaw.size(), (u32)cachePacked.size()};
+  return true;
+}
+
+// 'raw' is scratch space, const so workers can decode side by side.
+chunk::Chunk *ChunkStore::DecodeBlock(const SaveChunkHeader &header,
+                                      const std::vector<u8> &data,
+                                      std::vector<u8> &raw) const {
+  chunk::Chunk *c = new chunk::Chunk;
+  if (!codec::Decompress(data.data(), data.size(), header.rawSize, raw) ||
+      !codec::DecodeChunk(raw.data(), raw.size(), *c)) {
+    delete c;
+    return nullptr;
+  }
+  return c;
+}
+
+// Puts a restored chunk back into the live directory. Not marked dirty,
+// the slot reads the same as before.
+void ChunkStore::Install(int slot, chunk::Chunk *c) {
+  c->generation = generation + 1;
+  live[slot] = c;
+  lastTouched[slot] = touchClock;
+  chunksLoaded++;
+  isDirty = true;
+}
+
+// Takes the chunk out of the live directory, readers may still hold it.
+void ChunkStore::Release(int slot) {
+  replaced.push_back(live[slot]);
+  live[slot] = nullptr;
+  chunksLoaded--;
+  isDirty = true;
+}
+
+// Pristine chunks are only released, they read as the base world anyway.
+// Returns the unpacked size of the block.
+size_t ChunkStore::Pack(int slot) {
+  SaveChunkHeader header = {};
+  if (EncodeBlock(slot, *live[slot], header)) {
+    packed[slot] = new chunk::PackedChunk{header, cachePacked};
+    residency[slot] = chunk::PACKED;
+    chunksPacked++;
+    packedBytes += cachePacked.size();
+  }
+  Release(slot);
+  return header.rawSize;
+}
+
+// The block is only freed once it decoded, a failure leaves the slot
+// packed.
+bool ChunkStore::Unpack(int slot) {
+  auto start = std::chrono::high_resolution_clock::now();
+  chunk::PackedChunk *p = packed[slot];
+  u32 rawSize = p->header.rawSize;
+  chunk::Chunk *c = DecodeBlock(p->header, p->data, cacheRaw);
+  if (c == nullptr) {
+    std::cout << "Error unpacking chunk " << slot << std::endl;
+    return false;
+  }
+  FreePacked(slot);
+  residency[slot] = chunk::RESIDENT;
+  Install(slot, c);
+
+  std::chrono::duration<double, std::micro> elapsed =
+      std::chrono::high_resolution_clock::now() - start;
+  unpackRate = rawSize / std::max(elapsed.count(), 1e-3);
+  return true;
+}
+
+// Writes the chunk to the cache and releases it. Packed chunks are written
+// as they are.
+bool ChunkStore::Evict(int slot) {
+  if (residency[slot] == chunk::PACKED) {
+    const chunk::PackedChunk *p = packed[slot];
+    if (!cache.Write(slot, p->header, p->data)) {
+      return false;
+    }
+    FreePacked(slot);
+    residency[slot] = chunk::EVICTED;
+    chunksEvicted++;
+    evictCount++;
+    return true;
+  }
+
+  SaveChunkHeader header;
+  if (EncodeBlock(slot, *live[slot], header)) {
+    if (!cache.Write(slot, header, cachePacked)) {
+      return false;
+    }
+    residency[slot] = chunk::EVICTED;
+    chunksEvicted++;
+  }
+  Release(slot);
+  evictCount++;
+  return true;
+}
+
+// A block that cannot be read stays in the cache, the slot stays evicted.
+bool ChunkStore::Reload(int slot) {
+  auto start = std::chrono::high_resolution_clock::now();
+  SaveChunkHeader header;
+  chunk::Chunk *c = nullptr;
+  if (cache.Read(slot, header, cachePacked)) {
+    c = DecodeBlock(header, cachePacked, cacheRaw);
+  }
+  if (c == nullptr) {
+    std::cout << "Error reloading chunk " << slot << " from the cache"
+              << std::endl;
+    return false;
+  }
+  residency[slot] = chunk::RESIDENT;
+  chunksEvicted--;
+  Install(slot, c);
+  reloadCount++;
+
+  std::chrono::duration<double, std::micro> elapsed =
+      std::chrono::high_resolution_clock::now() - start;
+  reloadTime = elapsed.count();
+  return true;
+}
+
+bool ChunkStore::Restore(int slot) {
+  return residency[slot] == chunk::PACKED ? Unpack(slot) : Reload(slot);
+}
+
+// Forgets the cold copy of 'slot'. False if there was none.
+bool ChunkStore::DropCold(int slot) {
+  if (residency[slot] == chunk::PACKED) {
+    FreePacked(slot);
+  } else if (residency[slot] == chunk::EVICTED) {
+    chunksEvicted--;
+  } else {
+    return false;
+  }
+  residency[slot] = chunk::RESIDENT;
+  return true;
+}
+
+void ChunkStore::FreePacked(int slot) {
+  chunk::PackedChunk *p = packed[slot];
+  if (p == nullptr) {
+    return;
+  }
+  packedBytes -= p->data.size();
+  chunksPacked--;
+  delete p;
+  packed[slot] = nullptr;
+}
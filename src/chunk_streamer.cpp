@@ -0,0 +1,266 @@
+#include "chunk_streamer.h"
+#include "chunk_store.h"
+#include "defines.h"
+#include "parallel.h"
+#include <algorithm>
+#include <chrono>
+
+bool StreamRequest::operator==(const StreamRequest &other) const {
+  return slot == other.slot && version == other.version;
+}
+
+// --- Constructors ---
+ChunkStreamer::ChunkStreamer() {
+  chunks = nullptr;
+  updateCount = 0;
+  isRunning = false;
+  isBusy = false;
+  finished = nullptr;
+  readerID = -1;
+  bakeTime = 0.0;
+}
+
+ChunkStreamer::~ChunkStreamer() { Stop(); }
+
+// --- Core Lifecycle ---
+void ChunkStreamer::Start(ChunkStore *chunks, BakeFunc bake) {
+  if (worker.joinable()) {
+    return;
+  }
+  this->chunks = chunks;
+  this->bake = bake;
+  int slots = chunks->GetChunkSlots();
+  baked.assign(slots, nullptr);
+  versions.assign(slots, 0);
+  lastWanted.assign(slots, 0);
+  readerID = chunks->RegisterReader();
+
+  isRunning = true;
+  worker = std::thread(&ChunkStreamer::WorkerLoop, this);
+}
+
+void ChunkStreamer::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(requestMutex);
+    isRunning = false;
+    requests.clear();
+  }
+  requestCV.notify_all();
+  if (worker.joinable()) {
+    worker.join();
+  }
+  DrainFinished();
+  while (!residentSlots.empty()) {
+    Drop(residentSlots.back());
+  }
+}
+
+void ChunkStreamer::Update(const std::vector<StreamRequest> &wanted) {
+  if (!worker.joinable()) {
+    return;
+  }
+  // Take over everything the worker finished since the last call
+  BakedChunk *b = finished.exchange(nullptr, std::memory_order_acquire);
+  while (b != nullptr) {
+    BakedChunk *next = b->next;
+    Install(b);
+    b = next;
+  }
+
+  GrowTables();
+
+  updateCount++;
+  missing.clear();
+  for (const StreamRequest &w : wanted) {
+    lastWanted[w.slot] = updateCount;
+    if (baked[w.slot] == nullptr) {
+      missing.push_back({w.slot, w.cq, w.cr, versions[w.slot]});
+    }
+  }
+  Evict();
+
+  // Only post when the wish list changed, the worker keeps its place in an
+  // unchanged one.
+  if (missing == lastPosted) {
+    return;
+  }
+  lastPosted = missing;
+  {
+    std::lock_guard<std::mutex> lock(requestMutex);
+    requests = missing;
+  }
+  requestCV.notify_one();
+}
+
+void ChunkStreamer::BakeNow(const std::vector<StreamRequest> &wanted) {
+  if (!worker.joinable()) {
+    return;
+  }
+  GrowTables();
+
+  // Take the worker off its list, the bakes below share its reader slot
+  {
+    std::lock_guard<std::mutex> lock(requestMutex);
+    requests.clear();
+  }
+  WaitIdle();
+  lastPosted.clear();
+
+  std::vector<BakedChunk *> fresh;
+  for (const StreamRequest &w : wanted) {
+    lastWanted[w.slot] = updateCount;
+    if (baked[w.slot] == nullptr) {
+      BakedChunk *b = new BakedChunk;
+      b->slot = w.slot;
+      b->cq = w.cq;
+      b->cr = w.cr;
+      b->version = versions[w.slot];
+      fresh.push_back(b);
+    }
+  }
+  const WorldSnapshot *snap = chunks->AcquireSnapshot(readerID);
+  parallel::For((int)fresh.size(), [&](int i, int) { bake(snap, *fresh[i]); });
+  chunks->ReleaseSnapshot(readerID);
+
+  for (BakedChunk *b : fresh) {
+    Install(b);
+  }
+}
+
+void ChunkStreamer::Invalidate(int slot) {
+  // Slots past the table were never requested
+  if (slot >= (int)baked.size()) {
+    return;
+  }
+  versions[slot]++;
+  Drop(slot);
+}
+
+void ChunkStreamer::Clear() {
+  {
+    std::lock_guard<std::mutex> lock(requestMutex);
+    requests.clear();
+  }
+  WaitIdle();
+  DrainFinished();
+  while (!residentSlots.empty()) {
+    Drop(residentSlots.back());
+  }
+  for (u32 &v : versions) {
+    v++;
+  }
+  lastPosted.clear();
+}
+
+// --- Getters ---
+const BakedChunk *ChunkStreamer::Find(int slot) const {
+  return slot >= 0 && slot < (int)baked.size() ? baked[slot] : nullptr;
+}
+
+int ChunkStreamer::GetChunksBaked() const { return (int)residentSlots.size(); }
+double ChunkStreamer::GetBakeTime() const { return bakeTime; }
+
+// --- Private Methods ---
+void ChunkStreamer::WorkerLoop() {
+  while (true) {
+    StreamRequest request;
+    {
+      std::unique_lock<std::mutex> lock(requestMutex);
+      requestCV.wait(lock, [this] { return !requests.empty() || !isRunning; });
+      if (!isRunning) {
+        return;
+      }
+      request = requests.front();
+      requests.erase(requests.begin());
+      isBusy = true;
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    BakedChunk *b = new BakedChunk;
+    b->slot = request.slot;
+    b->cq = request.cq;
+    b->cr = request.cr;
+    b->version = request.version;
+    const WorldSnapshot *snap = chunks->AcquireSnapshot(readerID);
+    bake(snap, *b);
+    chunks->ReleaseSnapshot(readerID);
+
+    // Hand over, the logic thread picks the whole list up at once
+    b->next = finished.load(std::memory_order_relaxed);
+    while (!finished.compare_exchange_weak(
+        b->next, b, std::memory_order_release, std::memory_order_relaxed)) {
+    }
+
+    std::chrono::duration<double, std::micro> elapsed =
+        std::chrono::high_resolution_clock::now() - start;
+    bakeTime = elapsed.count();
+    {
+      std::lock_guard<std::mutex> lock(requestMutex);
+      isBusy = false;
+    }
+    requestCV.notify_all();
+  }
+}
+
+void ChunkStreamer::Install(BakedChunk *b) {
+  // Stale or baked twice after the wish list changed mid-bake
+  if (b->version != versions[b->slot] || baked[b->slot] != nullptr) {
+    delete b;
+    return;
+  }
+  baked[b->slot] = b;
+  residentSlots.push_back(b->slot);
+}
+
+// Keeps at most STREAM_MAX_CHUNKS baked, dropping the ones that were wanted
+// the longest time ago.
+void ChunkStreamer::Evict() {
+  int excess = (int)residentSlots.size() - conf::STREAM_MAX_CHUNKS;
+  if (excess <= 0) {
+    return;
+  }
+  std::sort(residentSlots.begin(), residentSlots.end(),
+            [this](int a, int b) { return lastWanted[a] > lastWanted[b]; });
+  for (int i = 0; i < excess; i++) {
+    int slot = residentSlots.back();
+    residentSlots.pop_back();
+    delete baked[slot];
+    baked[slot] = nullptr;
+  }
+}
+
+void ChunkStreamer::Drop(int slot) {
+  if (baked[slot] == nullptr) {
+    return;
+  }
+  delete baked[slot];
+  baked[slot] = nullptr;
+  auto it = std::find(residentSlots.begin(), residentSlots.end(), slot);
+  *it = residentSlots.back();
+  residentSlots.pop_back();
+}
+
+void ChunkStreamer::DrainFinished() {
+  BakedChunk *b = finished.exchange(nullptr, std::memory_order_acquire);
+  while (b != nullptr) {
+    BakedChunk *next = b->next;
+    delete b;
+    b = next;
+  }
+}
+
+// Unbounded worlds hand out slots as they are explored
+void ChunkStreamer::GrowTables() {
+  size_t slots = chunks->GetChunkSlots();
+  if (baked.size() < slots) {
+    baked.resize(slots, nullptr);
+    versions.resize(slots, 0);
+    lastWanted.resize(slots, 0);
+  }
+}
+
+void ChunkStreamer::WaitIdle() {
+  std::unique_lock<std::mutex> lock(requestMutex);
+  requestCV.wait(lock, [this] { return !isBusy; });
+}
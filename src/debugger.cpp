@@ -28,6 +28,7 @@ Debugger::Debugger() {
   displayRenderTime = 0.0;
   displayLogicTime = 0.0;
   displayVisTime = 0.0;
+  displayVisLatency = 0.0;
   displayRamUsage = 0.0;
 }
 
@@ -45,6 +46,7 @@ void Debugger::Update(const RenderState &rs, float dt, double logicTime,
     displayRenderTime = renderTime;
     displayLogicTime = logicTime;
     displayVisTime = rs.visCalcTime;
+    displayVisLatency = rs.visLatency;
     displayRamUsage = GetRamUsageMB();
     debugUpdateTimer = 0.0f;
   }
@@ -60,10 +62,31 @@ void Debugger::Update(const RenderState &rs, float dt, double logicTime,
            TextFormat("Tiles Total: %i", rs.tilesTotal),
            TextFormat("Tiles Used: %i", rs.tilesUsed),
            TextFormat("Tiles Visible: %i", rs.tilesVisible),
-           TextFormat("Map radius: %i", rs.mapRadius),
+           TextFormat("Visible Delta: +%i -%i", rs.tilesEntered,
+                      rs.tilesExited),
+           rs.mapRadius == 0 ? "Map radius: unbounded"
+                             : TextFormat("Map radius: %i", rs.mapRadius),
+           TextFormat("Chunks Loaded: %i", rs.chunksLoaded),
+           TextFormat("Tile Memory: %.2f MB", rs.tileMemoryMB),
            TextFormat("Render Time: %.2f ms", displayRenderTime),
            TextFormat("Logic Time: %.2f ms", displayLogicTime),
-           TextFormat("Culling Time: %.2f ms", displayVisTime),
+           TextFormat("Culling Time: %.1f us", displayVisTime * 1000.0),
+           TextFormat("Culling Latency: %.2f ms", displayVisLatency),
+           TextFormat("World Load: %.2f ms", rs.worldLoadTime),
+           TextFormat("First Frame: %.1f ms (spawn %.2f ms)",
+                      rs.firstFrameTime, rs.spawnTime),
+           TextFormat("Autosave: %.1f us, %.1f KB", rs.autosaveSnapshotTime,
+                      rs.autosaveKB),
+           TextFormat("Streaming: %i chunks, %.1f us/chunk, %i misses",
+                      rs.chunksBaked, rs.streamBakeTime, rs.streamMisses),
+           TextFormat("Chunk Cache: %i on disk, %i out, %i in",
+                      rs.chunksEvicted, rs.evictCount, rs.reloadCount),
+           TextFormat("Evict / Reload: %.1f / %.1f us", rs.evictTime,
+                      rs.reloadTime),
+           TextFormat("Cold Chunks: %i packed, %.1f KB", rs.chunksPacked,
+                      rs.packedKB),
+           TextFormat("Pack / Unpack: %.0f / %.0f MB/s", rs.packRate,
+                      rs.unpackRate),
        }});
 
   debugData.push_back(
@@ -82,6 +105,8 @@ void Debugger::Update(const RenderState &rs, float dt, double logicTime,
            TextFormat("X,Y: %.1f,%.1f", rs.playerPos.x, rs.playerPos.y),
            TextFormat("Tile Q,R: %i,%i", rs.playerTileCoord.q,
                       rs.playerTileCoord.r),
+           TextFormat("Origin Q,R: %i,%i", rs.originTile.q,
+                      rs.originTile.r),
            TextFormat("State:  %s", rs.playerStateStr.c_str()),
            TextFormat("Face Dir: %s", rs.playerDirStr.c_str()),
            TextFormat("Frame: %i", rs.playerFrame),
@@ -11,10 +11,11 @@ FontHandler::FontHandler() {
 
   this->fontSizeDefault = conf::DEFAULT_FONT_SIZE;
   this->fontHackRegular = {0};
+  this->firstGlyph = {0, 0};
 }
 
 // --- Core Lifecycle ---
-void FontHandler::LoadFonts() {
+void FontHandler::LoadFonts(GFX_Manager *gfx) {
   int fileSize = 0;
 
   // --- Hack Font Regular ---
@@ -32,6 +33,9 @@ void FontHandler::LoadFonts() {
   this->fontHackRegular.texture = LoadTextureFromImage(atlas);
   UnloadImage(atlas);
   UnloadFileData(fileData);
+  this->firstGlyph =
+      gfx->AddTexture(fontHackRegular.texture, fontHackRegular.recs,
+                      fontHackRegular.glyphCount);
 }
 
 void FontHandler::UnloadFonts() { UnloadFont(fontHackRegular); }
@@ -66,13 +70,9 @@ void FontHandler::QueueText(GFX_Manager *gfx, const char *text, Vector2 pos,
       Rectangle srcRec = fontHackRegular.recs[index];
       GlyphInfo glyph = fontHackRegular.glyphs[index];
 
-      Rectangle dstRec = {currentPos.x + glyph.offsetX,
-                          currentPos.y + glyph.offsetY, srcRec.width,
-                          srcRec.height};
-
-      gfx->LoadTextureToBackbuffer_Raw(layer, fontHackRegular.texture, srcRec,
-                                       dstRec,
-                                       {.color = col, .origin = {0.0f, 0.0f}});
+      gfx->LoadSpriteToBackbuffer(
+          layer, {(u16)(firstGlyph.id + index), firstGlyph.texture},
+          {currentPos.x + glyph.offsetX, currentPos.y + glyph.offsetY}, col);
 
       if (glyph.advanceX == 0)
         currentPos.x += (float)srcRec.width + spacing;
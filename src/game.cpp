@@ -4,15 +4,22 @@
 #include "font_handler.h"
 #include "hex_tile_grid.h"
 #include "raylib.h"
+#include "save_format.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
 
 // --- Constructors ---
 Game::Game() {
+  startTime = std::chrono::high_resolution_clock::now();
   isRunning = true;
   isFullscreenMode = false;
   logicUpdateReady = false;
   logicUpdateDone = true;
   logicExecutionTime = 0.0;
   renderExecutionTime = 0.0;
+  firstFrameTime = 0.0;
   debugUpdateTimer = 0.0f;
   displayRenderTime = 0.0;
   displayLogicTime = 0.0;
@@ -47,8 +54,20 @@ Game::Game() {
   worldState.cameraTopLeft = {0, 0};
 
   worldState.itemHandler.SetFrameContext(&frameContext);
+  if (FileExists(conf::SAVE_FILE_PATH)) {
+    LoadGame();
+  }
+  // Changes made after the last full save
+  worldState.hexGrid.ReplayAutosave();
+
+  // Spawn area first, the rest streams in while the game runs
+  frameContext.screen.width = GetScreenWidth();
+  frameContext.screen.height = GetScreenHeight();
+  worldState.camera.target = worldState.player.GetPosition();
+  UpdateCamera();
+  worldState.hexGrid.InitSpawn(worldState.cameraRect);
 
-  fontHandler.LoadFonts();
+  fontHandler.LoadFonts(&gfxManager);
 
   uiHandler.SetGFX_Manager(&gfxManager);
   uiHandler.SetItemHandler(&worldState.itemHandler);
@@ -72,6 +91,7 @@ Game::~Game() { Unload(); }
 
 // --- Core Lifecycle ---
 void Game::GameLoop() {
+  int framesDrawn = 0;
   while (!WindowShouldClose()) {
 
     // Gather Input
@@ -106,6 +126,17 @@ void Game::GameLoop() {
       std::chrono::duration<double, std::milli> elapsedRender =
           endRender - startRender;
       renderExecutionTime = elapsedRender.count();
+
+      // The logic thread fills the back buffer during the first frame, the
+      // second one is the first to show the world.
+      if (++framesDrawn == 2) {
+        std::chrono::duration<double, std::milli> sinceStart =
+            endRender - startTime;
+        firstFrameTime = sinceStart.count();
+        std::cout << "First frame after " << firstFrameTime.load()
+                  << " ms (spawn area " << worldState.hexGrid.GetSpawnTime()
+                  << " ms)" << std::endl;
+      }
     }
 
     // Synchronise with logic thread
@@ -135,6 +166,8 @@ void Game::Unload() {
   if (logicThread.joinable()) {
     logicThread.join();
   }
+  SaveGame();
+  worldState.hexGrid.Shutdown();
 
   gfxManager.UnloadAssets();
   fontHandler.UnloadFonts();
@@ -183,35 +216,46 @@ void Game::GetInputs() {
   frameContext.inputs.commands.down = IsKeyDown(KEY_S);
 
   frameContext.inputs.commands.toggleInventory = IsKeyPressed(KEY_I);
+  frameContext.inputs.commands.quickSave = IsKeyPressed(KEY_F5);
+  frameContext.inputs.commands.quickLoad = IsKeyPressed(KEY_F9);
 }
 
 void Game::RunLogic() {
   auto startLogic = std::chrono::high_resolution_clock::now();
 
+  // --- Floating origin ---
+  Vector2 shift = worldState.hexGrid.Rebase(worldState.player.GetPosition());
+  if (shift.x != 0.0f || shift.y != 0.0f) {
+    worldState.player.Shift(shift);
+    worldState.camera.target.x -= shift.x;
+    worldState.camera.target.y -= shift.y;
+  }
+
   UpdateFrameContext();
 
   // Player Update
   worldState.player.Update();
 
   // --- Update camera ---
-  worldState.camera.offset = Vector2{(float)frameContext.screen.width / 2.0f,
-                                     (float)frameContext.screen.height / 2.0f};
-  worldState.cameraTopLeft =
-      GetScreenToWorld2D(Vector2{0, 0}, worldState.camera);
-  float camWidth = (float)frameContext.screen.width / worldState.camera.zoom;
-  float camHeight = (float)frameContext.screen.height / worldState.camera.zoom;
-  worldState.cameraRect = {worldState.cameraTopLeft.x,
-                           worldState.cameraTopLeft.y, camWidth, camHeight};
-  worldState.camera.target = worldState.player.GetPosition();
+  UpdateCamera();
 
   // --- Update UI Layout ---
   uiHandler.UpdateScreenSize(frameContext.screen.width,
                              frameContext.screen.height);
 
   // --- Update Grid ---
+  worldState.hexGrid.SetPrefetchVelocity(worldState.player.GetVelocity());
   worldState.hexGrid.Update(worldState.camera, frameContext.deltaTime);
   uiHandler.Update();
 
+  // --- Quick save / load ---
+  if (frameContext.inputs.commands.quickSave) {
+    SaveGame();
+  }
+  if (frameContext.inputs.commands.quickLoad && LoadGame()) {
+    worldState.hexGrid.ResetAutosave();
+  }
+
   // --- Process right click ---
   if (frameContext.inputs.mouseClick.right) {
     HexCoord clickedHex =
@@ -227,8 +271,32 @@ void Game::RunLogic() {
   rs.tilesUsed = worldState.hexGrid.GetTilesInUse();
   //
   rs.tilesVisible = worldState.hexGrid.GetTilesVisible();
+  rs.tilesEntered = worldState.hexGrid.GetEnteredTiles().size();
+  rs.tilesExited = worldState.hexGrid.GetExitedTiles().size();
   rs.mapRadius = worldState.hexGrid.GetMapRadius();
+  rs.chunksLoaded = worldState.hexGrid.GetChunksLoaded();
+  rs.tileMemoryMB =
+      (double)worldState.hexGrid.GetTileMemoryUsage() / (1024 * 1024);
   rs.visCalcTime = worldState.hexGrid.GetVisCalcTime();
+  rs.visLatency = worldState.hexGrid.GetVisLatency();
+  rs.worldLoadTime = worldState.hexGrid.GetLoadTime();
+  rs.spawnTime = worldState.hexGrid.GetSpawnTime();
+  rs.firstFrameTime = firstFrameTime;
+  rs.autosaveSnapshotTime = worldState.hexGrid.GetAutosaveSnapshotTime();
+  rs.autosaveKB =
+      (double)worldState.hexGrid.GetAutosaveBytesWritten() / 1024.0;
+  rs.chunksBaked = worldState.hexGrid.GetChunksBaked();
+  rs.streamBakeTime = worldState.hexGrid.GetStreamBakeTime();
+  rs.streamMisses = worldState.hexGrid.GetStreamMisses();
+  rs.chunksEvicted = worldState.hexGrid.GetChunksEvicted();
+  rs.evictCount = worldState.hexGrid.GetEvictCount();
+  rs.reloadCount = worldState.hexGrid.GetReloadCount();
+  rs.evictTime = worldState.hexGrid.GetEvictTime();
+  rs.reloadTime = worldState.hexGrid.GetReloadTime();
+  rs.chunksPacked = worldState.hexGrid.GetChunksPacked();
+  rs.packedKB = (double)worldState.hexGrid.GetPackedBytes() / 1024.0;
+  rs.packRate = worldState.hexGrid.GetPackRate();
+  rs.unpackRate = worldState.hexGrid.GetUnpackRate();
 
   rs.mouseTileCoord =
       worldState.hexGrid.PointToHexCoord(frameContext.world.mousePos);
@@ -238,6 +306,7 @@ void Game::RunLogic() {
   rs.playerPos = worldState.player.GetPosition();
   rs.playerTileCoord = worldState.hexGrid.PointToHexCoord(rs.playerPos);
   rs.playerTileID = worldState.hexGrid.PointToType(rs.playerPos);
+  rs.originTile = worldState.hexGrid.GetOriginTile();
   rs.playerStateStr = worldState.player.PlayerStateToString();
   rs.playerDirStr = worldState.player.PlayerDirToString();
   rs.playerFrame = worldState.player.GetAnimationFrame();
@@ -259,11 +328,72 @@ void Game::RunLogic() {
   logicExecutionTime = elapsedLogic.count();
 }
 
+// Written next to the save and renamed over it once complete, a failed
+// save leaves the previous one in place.
+bool Game::SaveGame() {
+  std::ofstream out(conf::SAVE_TMP_FILE_PATH, std::ios::binary);
+  SaveHeader header = {};
+  std::memcpy(header.magic, SAVE_MAGIC, sizeof(header.magic));
+  header.version = SAVE_VERSION;
+  out.write((const char *)&header, sizeof(header));
+
+  bool isWritten = out && worldState.hexGrid.Save(out) &&
+                   worldState.itemHandler.Save(out);
+  out.flush();
+  isWritten = isWritten && out.good();
+  out.close();
+
+  std::error_code error;
+  if (isWritten) {
+    std::filesystem::rename(conf::SAVE_TMP_FILE_PATH, conf::SAVE_FILE_PATH,
+                            error);
+  }
+  if (!isWritten || error) {
+    std::cout << "Error saving " << conf::SAVE_FILE_PATH << std::endl;
+    std::filesystem::remove(conf::SAVE_TMP_FILE_PATH, error);
+    return false;
+  }
+
+  // Everything in the journal is part of the save now
+  worldState.hexGrid.ResetAutosave();
+  return true;
+}
+
+// The whole file is read and checked before anything is replaced, a
+// damaged save keeps the current world and items.
+bool Game::LoadGame() {
+  std::ifstream in(conf::SAVE_FILE_PATH, std::ios::binary);
+  SaveHeader header;
+  in.read((char *)&header, sizeof(header));
+  if (!in || std::memcmp(header.magic, SAVE_MAGIC, sizeof(SAVE_MAGIC)) != 0 ||
+      header.version != SAVE_VERSION) {
+    std::cout << "Error loading " << conf::SAVE_FILE_PATH << std::endl;
+    return false;
+  }
+
+  // Items are applied by their Load(), only if their section is intact
+  WorldSave world;
+  if (!worldState.hexGrid.ReadSave(in, world) ||
+      !worldState.itemHandler.Load(in)) {
+    std::cout << "Error loading " << conf::SAVE_FILE_PATH << std::endl;
+    return false;
+  }
+  worldState.hexGrid.ApplySave(world);
+  std::cout << "Loaded " << conf::SAVE_FILE_PATH << ": "
+            << worldState.hexGrid.GetChunksLoaded() +
+                   worldState.hexGrid.GetChunksPacked()
+            << " chunks in "
+            << worldState.hexGrid.GetLoadTime() << " ms" << std::endl;
+  return true;
+}
+
 void Game::LoadBackBuffer() {
   worldState.hexGrid.LoadBackBuffer();
   worldState.player.LoadBackBuffer();
   uiHandler.LoadBackBuffer();
   debugger.LoadBackBuffer();
+  // Sorting is part of producing the frame, the render thread only draws
+  gfxManager.SortBackBuffer();
 }
 
 void Game::LogicLoop() {
@@ -283,6 +413,18 @@ void Game::LogicLoop() {
   }
 }
 
+void Game::UpdateCamera() {
+  worldState.camera.offset = Vector2{(float)frameContext.screen.width / 2.0f,
+                                     (float)frameContext.screen.height / 2.0f};
+  worldState.cameraTopLeft =
+      GetScreenToWorld2D(Vector2{0, 0}, worldState.camera);
+  float camWidth = (float)frameContext.screen.width / worldState.camera.zoom;
+  float camHeight = (float)frameContext.screen.height / worldState.camera.zoom;
+  worldState.cameraRect = {worldState.cameraTopLeft.x,
+                           worldState.cameraTopLeft.y, camWidth, camHeight};
+  worldState.camera.target = worldState.player.GetPosition();
+}
+
 void Game::UpdateFrameContext() {
 
   // --- Update delta time ---
@@ -304,10 +446,9 @@ void Game::UpdateFrameContext() {
   frameContext.world.hoveredTilePoint = worldState.hexGrid.HexCoordToPoint(
       frameContext.world.hoveredTileHexCoords);
   frameContext.world.hoveredRsrcPoint = frameContext.world.hoveredTilePoint;
-  if (frameContext.world.hoveredTile &&
-      frameContext.world.hoveredTile->rsrc.id >= 0) {
+  if (frameContext.world.hoveredTile.rsrc.id >= 0) {
     frameContext.world.hoveredRsrcPoint =
-        frameContext.world.hoveredTile->rsrc.worldPos;
+        frameContext.world.hoveredTile.rsrc.worldPos;
   }
 
   // Screen variables
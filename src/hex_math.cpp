@@ -0,0 +1,296 @@
+#include "hex_math.h"
+#include "raylib.h"
+#include <cmath>
+
+#if defined(HEX_MATH_NO_SIMD)
+// Scalar loops only, HEXVILE_SIMD=NONE
+#elif defined(__AVX2__)
+#include <immintrin.h>
+#define HEX_MATH_SIMD
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define HEX_MATH_SIMD
+#endif
+
+// --- Lanes ---
+// The few vector operations the kernels need, so one kernel serves both
+// instruction sets. Float to int conversion rounds to nearest even, like
+// RoundNearest() in the scalar loops.
+namespace {
+// std::lrint is a libm call unless math errno is off, cvtss2si is one
+// instruction with the same rounding.
+inline int RoundNearest(float f) {
+#ifdef HEX_MATH_SIMD
+  return _mm_cvtss_si32(_mm_set_ss(f));
+#else
+  return (int)std::lrint(f);
+#endif
+}
+
+#if defined(HEX_MATH_SIMD) && defined(__AVX2__)
+constexpr int LANES = 8;
+using VF = __m256;
+using VI = __m256i;
+
+inline VF LoadF(const float *p) { return _mm256_loadu_ps(p); }
+inline VI LoadI(const int *p) { return _mm256_loadu_si256((const VI *)p); }
+inline void StoreF(float *p, VF v) { _mm256_storeu_ps(p, v); }
+inline void StoreI(int *p, VI v) { _mm256_storeu_si256((VI *)p, v); }
+inline VF SetF(float f) { return _mm256_set1_ps(f); }
+inline VI SetI(int i) { return _mm256_set1_epi32(i); }
+inline VI Iota() { return _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7); }
+inline VF Add(VF a, VF b) { return _mm256_add_ps(a, b); }
+inline VF Sub(VF a, VF b) { return _mm256_sub_ps(a, b); }
+inline VF Mul(VF a, VF b) { return _mm256_mul_ps(a, b); }
+inline VI AddI(VI a, VI b) { return _mm256_add_epi32(a, b); }
+inline VI SubI(VI a, VI b) { return _mm256_sub_epi32(a, b); }
+inline VI Round(VF v) { return _mm256_cvtps_epi32(v); }
+inline VF ToFloat(VI v) { return _mm256_cvtepi32_ps(v); }
+inline VF Abs(VF v) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), v); }
+inline VI Greater(VF a, VF b) {
+  return _mm256_castps_si256(_mm256_cmp_ps(a, b, _CMP_GT_OQ));
+}
+inline VI And(VI a, VI b) { return _mm256_and_si256(a, b); }
+inline VI AndNot(VI a, VI b) { return _mm256_andnot_si256(a, b); }
+inline VI Select(VI mask, VI a, VI b) {
+  return _mm256_blendv_epi8(b, a, mask);
+}
+#elif defined(HEX_MATH_SIMD)
+constexpr int LANES = 4;
+using VF = __m128;
+using VI = __m128i;
+
+inline VF LoadF(const float *p) { return _mm_loadu_ps(p); }
+inline VI LoadI(const int *p) { return _mm_loadu_si128((const VI *)p); }
+inline void StoreF(float *p, VF v) { _mm_storeu_ps(p, v); }
+inline void StoreI(int *p, VI v) { _mm_storeu_si128((VI *)p, v); }
+inline VF SetF(float f) { return _mm_set1_ps(f); }
+inline VI SetI(int i) { return _mm_set1_epi32(i); }
+inline VI Iota() { return _mm_setr_epi32(0, 1, 2, 3); }
+inline VF Add(VF a, VF b) { return _mm_add_ps(a, b); }
+inline VF Sub(VF a, VF b) { return _mm_sub_ps(a, b); }
+inline VF Mul(VF a, VF b) { return _mm_mul_ps(a, b); }
+inline VI AddI(VI a, VI b) { return _mm_add_epi32(a, b); }
+inline VI SubI(VI a, VI b) { return _mm_sub_epi32(a, b); }
+inline VI Round(VF v) { return _mm_cvtps_epi32(v); }
+inline VF ToFloat(VI v) { return _mm_cvtepi32_ps(v); }
+inline VF Abs(VF v) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), v); }
+inline VI Greater(VF a, VF b) { return _mm_castps_si128(_mm_cmpgt_ps(a, b)); }
+inline VI And(VI a, VI b) { return _mm_and_si128(a, b); }
+inline VI AndNot(VI a, VI b) { return _mm_andnot_si128(a, b); }
+inline VI Select(VI mask, VI a, VI b) {
+  return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+#endif
+} // namespace
+
+namespace hexmath {
+
+// --- Geometry ---
+// Checked by the compiler. Constant evaluation cannot allocate, so these
+// also prove the iterators never touch the heap.
+namespace {
+template <typename Tiles> constexpr int CountTiles(Tiles tiles) {
+  int n = 0;
+  for (HexCoord h : tiles) {
+    n += h == h;
+  }
+  return n;
+}
+
+// Every tile within 'radius' exactly once.
+template <typename Tiles>
+constexpr bool CoversRange(Tiles tiles, HexCoord center, int radius) {
+  for (HexCoord a : tiles) {
+    int seen = 0;
+    for (HexCoord b : tiles) {
+      seen += a == b;
+    }
+    if (seen != 1 || Distance(a, center) > radius) {
+      return false;
+    }
+  }
+  return CountTiles(tiles) == RangeSize(radius);
+}
+
+constexpr bool IsNearestFirst(HexCoord center, int radius) {
+  int prev = 0;
+  for (HexCoord h : Spiral(center, radius)) {
+    if (Distance(h, center) < prev) {
+      return false;
+    }
+    prev = Distance(h, center);
+  }
+  return true;
+}
+
+constexpr bool IsRing(HexCoord center, int radius) {
+  for (HexCoord h : Ring(center, radius)) {
+    if (Distance(h, center) != radius) {
+      return false;
+    }
+  }
+  return CountTiles(Ring(center, radius)) == (radius == 0 ? 1 : 6 * radius);
+}
+
+// Neighbor to neighbor from 'from' to 'to'.
+constexpr bool IsLine(HexCoord from, HexCoord to) {
+  HexCoord prev = from;
+  for (HexCoord h : Line(from, to)) {
+    if (Distance(prev, h) > 1) {
+      return false;
+    }
+    prev = h;
+  }
+  return prev == to && CountTiles(Line(from, to)) == Distance(from, to) + 1;
+}
+
+static_assert(Distance({0, 0}, {3, -5}) == 5);
+static_assert(IsRing({0, 0}, 0) && IsRing({4, -2}, 1) && IsRing({-9, 3}, 5));
+static_assert(CoversRange(Spiral({2, 7}, 3), {2, 7}, 3));
+static_assert(CoversRange(Range({-5, 1}, 3), {-5, 1}, 3));
+static_assert(CoversRange(Range({0, 0}, 0), {0, 0}, 0));
+static_assert(IsNearestFirst({1, 1}, 4));
+static_assert(IsLine({0, 0}, {0, 0}) && IsLine({-3, 2}, {8, -6}));
+static_assert(IsLine({5, 5}, {-7, 1}) && IsLine({0, 0}, {10, -5}));
+} // namespace
+
+// --- Points ---
+Layout MakeLayout(float gapX, float gapY, Vector2 origin) {
+  const float sqrt3 = std::sqrt(3.0f);
+  Layout l;
+  l.originX = origin.x;
+  l.originY = origin.y;
+  l.colWidth = gapX * sqrt3;
+  l.halfCol = gapX * sqrt3 / 2.0f;
+  l.rowHeight = gapY * 3.0f / 2.0f;
+  l.qPerX = sqrt3 / 3.0f / gapX;
+  l.qPerY = -1.0f / 3.0f / gapY;
+  l.rPerY = 2.0f / 3.0f / gapY;
+  return l;
+}
+
+/* Cube rounding: round q, r and s = -q - r on their own, then rebuild the
+ * one that moved the most from the other two, so q + r + s stays 0.
+ */
+void ToCoord(const Layout &l, float x, float y, int &q, int &r) {
+  float dx = x - l.originX;
+  float dy = y - l.originY;
+  float fq = dx * l.qPerX + dy * l.qPerY;
+  float fr = dy * l.rPerY;
+  float fs = -fq - fr;
+  int iq = RoundNearest(fq);
+  int ir = RoundNearest(fr);
+  int is = RoundNearest(fs);
+  float dq = std::abs(iq - fq);
+  float dr = std::abs(ir - fr);
+  float ds = std::abs(is - fs);
+  q = dq > dr && dq > ds ? -ir - is : iq;
+  r = !(dq > dr && dq > ds) && dr > ds ? -iq - is : ir;
+}
+
+// --- Batches ---
+void ToPoints(const Layout &l, const int *q, const int *r, int count,
+              float *x, float *y) {
+  int i = 0;
+#ifdef HEX_MATH_SIMD
+  VF colWidth = SetF(l.colWidth);
+  VF halfCol = SetF(l.halfCol);
+  VF rowHeight = SetF(l.rowHeight);
+  VF originX = SetF(l.originX);
+  VF originY = SetF(l.originY);
+  for (; i + LANES <= count; i += LANES) {
+    VF fq = ToFloat(LoadI(q + i));
+    VF fr = ToFloat(LoadI(r + i));
+    StoreF(x + i, Add(Add(Mul(colWidth, fq), Mul(halfCol, fr)), originX));
+    StoreF(y + i, Add(Mul(rowHeight, fr), originY));
+  }
+#endif
+  ToPointsScalar(l, q + i, r + i, count - i, x + i, y + i);
+}
+
+void RowToPoints(const Layout &l, int q0, int r, int count, float *x,
+                 float *y) {
+  // y is shared, x still goes through the full formula so the tiles match
+  // ToPoint()
+  Vector2 first = ToPoint(l, q0, r);
+  int i = 0;
+#ifdef HEX_MATH_SIMD
+  VF colWidth = SetF(l.colWidth);
+  VF rowX = SetF(l.halfCol * r);
+  VF originX = SetF(l.originX);
+  VF rowY = SetF(first.y);
+  VI qv = AddI(SetI(q0), Iota());
+  for (; i + LANES <= count; i += LANES) {
+    StoreF(x + i, Add(Add(Mul(colWidth, ToFloat(qv)), rowX), originX));
+    StoreF(y + i, rowY);
+    qv = AddI(qv, SetI(LANES));
+  }
+#endif
+  for (; i < count; i++) {
+    x[i] = ToPoint(l, q0 + i, r).x;
+    y[i] = first.y;
+  }
+}
+
+void ToCoords(const Layout &l, const float *x, const float *y, int count,
+              int *q, int *r) {
+  int i = 0;
+#ifdef HEX_MATH_SIMD
+  VF originX = SetF(l.originX);
+  VF originY = SetF(l.originY);
+  VF qPerX = SetF(l.qPerX);
+  VF qPerY = SetF(l.qPerY);
+  VF rPerY = SetF(l.rPerY);
+  VF zero = SetF(0.0f);
+  for (; i + LANES <= count; i += LANES) {
+    VF dx = Sub(LoadF(x + i), originX);
+    VF dy = Sub(LoadF(y + i), originY);
+    VF fq = Add(Mul(dx, qPerX), Mul(dy, qPerY));
+    VF fr = Mul(dy, rPerY);
+    VF fs = Sub(Sub(zero, fq), fr);
+    VI iq = Round(fq);
+    VI ir = Round(fr);
+    VI is = Round(fs);
+    VF dq = Abs(Sub(ToFloat(iq), fq));
+    VF dr = Abs(Sub(ToFloat(ir), fr));
+    VF ds = Abs(Sub(ToFloat(is), fs));
+
+    VI qWorst = And(Greater(dq, dr), Greater(dq, ds));
+    VI rWorst = AndNot(qWorst, Greater(dr, ds));
+    VI zeroI = SetI(0);
+    StoreI(q + i, Select(qWorst, SubI(SubI(zeroI, ir), is), iq));
+    StoreI(r + i, Select(rWorst, SubI(SubI(zeroI, iq), is), ir));
+  }
+#endif
+  ToCoordsScalar(l, x + i, y + i, count - i, q + i, r + i);
+}
+
+void ToPointsScalar(const Layout &l, const int *q, const int *r, int count,
+                    float *x, float *y) {
+  // Local copy, stores to 'x' and 'y' could alias the layout otherwise
+  const Layout c = l;
+  for (int i = 0; i < count; i++) {
+    Vector2 p = ToPoint(c, q[i], r[i]);
+    x[i] = p.x;
+    y[i] = p.y;
+  }
+}
+
+void ToCoordsScalar(const Layout &l, const float *x, const float *y,
+                    int count, int *q, int *r) {
+  for (int i = 0; i < count; i++) {
+    ToCoord(l, x[i], y[i], q[i], r[i]);
+  }
+}
+
+const char *GetKernelName() {
+#if defined(HEX_MATH_SIMD) && defined(__AVX2__)
+  return "AVX2";
+#elif defined(HEX_MATH_SIMD)
+  return "SSE2";
+#else
+  return "scalar";
+#endif
+}
+} // namespace hexmath
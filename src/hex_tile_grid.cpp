@@ -1,44 +1,60 @@
 #include "hex_tile_grid.h"
 #include "GFX_manager.h"
+#include "chunk_store.h"
+#include "chunk_streamer.h"
 #include "defines.h"
 #include "enums.h"
+#include "hex_math.h"
+#include "map_tile.h"
 #include "raylib.h"
 #include "resource.h"
+#include "save_format.h"
 #include "texture.h"
+#include "tile_bits.h"
 #include "tile_details.h"
+#include <algorithm>
 #include <cmath>
+#include <istream>
+#include <ostream>
 #include <vector>
 
-const std::vector<HexCoord> HexGrid::DIRECTIONS = {
-    HexCoord(1, 0),  HexCoord(0, 1),  HexCoord(-1, 1),
-    HexCoord(-1, 0), HexCoord(0, -1), HexCoord(1, -1)};
-
-// ============= Hex Coordinates ====================
-HexCoord::HexCoord() : q(0), r(0) {}
-HexCoord::HexCoord(int q, int r) : q(q), r(r) {}
-
-HexCoord HexCoord::Add(const HexCoord &other) const {
-  return HexCoord(q + other.q, r + other.r);
+// --- Procedural Generation ---
+// splitmix64 finaliser, every input bit affects every output bit.
+static u64 Mix(u64 x) {
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ULL;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebULL;
+  x ^= x >> 31;
+  return x;
 }
 
-bool HexCoord::Equals(const HexCoord &other) const {
-  return q == other.q && r == other.r;
+// Pure function of its inputs, 'salt' separates the rolls of one tile.
+static u64 TileHash(u64 seed, HexCoord h, tile::id id, u32 salt) {
+  u64 x = Mix(seed ^ (u32)h.q);
+  return Mix(x ^ ((u64)(u32)h.r << 32 | (u64)id << 16 | salt));
 }
 
-HexCoord HexCoord::operator+(const HexCoord &other) const { return Add(other); }
-
-bool HexCoord::operator==(const HexCoord &other) const { return Equals(other); }
-
-bool HexCoord::operator!=(const HexCoord &other) const {
-  return !Equals(other);
+// Uniform value in [min, max] like GetRandomValue
+static int HashRange(u64 hash, int min, int max) {
+  return min + (int)(hash % (u64)(max - min + 1));
 }
 
-bool HexCoord::operator<(const HexCoord &other) const {
-  if (q != other.q)
-    return q < other.q;
-  return r < other.r;
+// --- Tile Properties ---
+// Bit per tile id in conf::WALKABLE_TILE_IDS.
+static constexpr u32 WalkableIDs() {
+  u32 mask = 0;
+  for (tile::id id : conf::WALKABLE_TILE_IDS) {
+    mask |= 1u << id;
+  }
+  return mask;
 }
 
+static constexpr u32 WALKABLE_IDS = WalkableIDs();
+static_assert(tile::SIZE <= 32, "Tile ids do not fit WALKABLE_IDS");
+
+static bool IsWalkableID(tile::id id) { return (WALKABLE_IDS >> id) & 1; }
+
 // ============= Hex Grid ===================
 
 // --- Constructors ---
@@ -48,197 +64,313 @@ HexGrid::HexGrid() {
   tileGapX = conf::TILE_SPACING_X;
   tileGapY = conf::TILE_SPACING_Y;
   origin = conf::SCREEN_CENTER;
-  mapRadius = conf::MAP_RADIUS;
+  originTile = HexCoord(0, 0);
+  hexLayout = hexmath::MakeLayout(tileGapX, tileGapY, origin);
+  mapRadius = conf::UNBOUNDED_WORLD ? 0 : conf::MAP_RADIUS;
+  worldSeed = conf::WORLD_SEED;
   gridSize = 0;
   tilesInUse = 0;
-  tilesInTotal = 0;
   camRect = nullptr;
   lastCamRect = {0, 0, 0, 0};
   visiCacheReady = false;
+  visiRequestedOnce = false;
+  visiWorkerRunning = false;
+  visiReaderID = -1;
+  visiRequestPending = false;
+  visiRequestRect = {0, 0, 0, 0};
+  visiRequestAnchor = HexCoord(0, 0);
+  prefetchVelocity = {0, 0};
+  streamMisses = 0;
+  evictTimer = 0.0f;
 
   size_t estimated_hits = conf::ESTIMATED_VISIBLE_TILES;
-  currentVisibleTiles.reserve(estimated_hits);
-  nextVisibleTiles.reserve(estimated_hits);
+  enteredTiles.reserve(estimated_hits);
+  nextEnteredTiles.reserve(estimated_hits);
 
   calcVisTime = 0.0;
+  visLatency = 0.0;
+  loadTime = 0.0;
+  spawnTime = 0.0;
 }
 
+HexGrid::~HexGrid() { Shutdown(); }
+
 // --- Core Lifecycle ---
 void HexGrid::InitGrid(float radius) {
 
   gridSize = mapRadius * 2 + 1;
-  tileData.resize(gridSize * gridSize);
 
-  // Init tile data
-  for (int r = -mapRadius; r <= mapRadius; r++) {
-    for (int q = -mapRadius; q <= mapRadius; q++) {
-      HexCoord h(q, r);
-      int gridR = r + mapRadius;
-      int gridQ = q + mapRadius;
-      this->tilesInTotal++;
-
-      Vector2 worldPos = CoordToPoint(q, r);
+  // Tiles are not materialised here, chunks are allocated on first touch.
+  chunks.Init(mapRadius);
+  tileBits.Init(&chunks, [this](int cq, int cr, tilebits::ChunkBits &bits) {
+    BuildTileBits(cq, cr, bits);
+  });
+  if (conf::MAPPED_TILE_STORAGE) {
+    chunks.MapFile(conf::WORLD_FILE_PATH, worldSeed);
+  } else {
+    chunks.OpenCache(conf::CHUNK_CACHE_PATH);
+  }
 
-      if (abs(q) + abs(r) + abs(-q - r) <= mapRadius * 2) {
+  tilesInUse = hexmath::RangeSize(mapRadius);
 
-        MapTile initTile = {.id = tile::GRASS};
-        initTile.posWorld = worldPos;
+  // Start the visibility worker, it sleeps until the first camera rect.
+  if (!visiWorker.joinable()) {
+    visiReaderID = chunks.RegisterReader();
+    visiWorkerRunning = true;
+    visiWorker = std::thread(&HexGrid::VisibilityWorkerLoop, this);
+  }
 
-        for (TileDet &d : initTile.det) {
-          d.taOffsetX = conf::UNINITIALIZED;
-        }
+  SaveWorldHeader header = {(u16)chunk::SHIFT, chunk::TILE_ORDER, mapRadius,
+                            worldSeed};
+  autosave.Start(&chunks, conf::JOURNAL_FILE_PATH, header);
 
-        rsrc::Object &rsrcObj = initTile.rsrc;
-        rsrcObj.id = rsrc::UNINITIALIZED;
+  if (conf::CHUNK_STREAMING_ENABLED) {
+    streamer.Start(&chunks, [this](const WorldSnapshot *snap, BakedChunk &b) {
+      BakeChunk(snap, b);
+    });
+  }
+}
 
-        tileData[gridR * gridSize + gridQ] = initTile;
-        this->tilesInUse++;
+void HexGrid::InitSpawn(Rectangle camView) {
+  auto start = std::chrono::high_resolution_clock::now();
 
-      } else {
-        tileData[gridR * gridSize + gridQ] =
-            (MapTile){.id = tile::NULL_ID, .posWorld = worldPos};
-      }
-    }
+  std::vector<StreamRequest> spawn;
+  CollectChunks(CalcRenderView(camView), spawn);
+  std::vector<int> slots;
+  for (const StreamRequest &s : spawn) {
+    slots.push_back(s.slot);
   }
-  CalcVisibleTiles();
+  chunks.Prefetch(slots);
+  chunks.Commit();
+  if (conf::CHUNK_STREAMING_ENABLED) {
+    streamer.BakeNow(spawn);
+  }
+
+  // The worker has no request yet, the window is computed right here and
+  // swapped in by the first Update()
+  CalcVisibleTiles(camView, originTile, start);
+  lastCamRect = camView;
+  visiRequestedOnce = true;
+
+  std::chrono::duration<double, std::milli> elapsed =
+      std::chrono::high_resolution_clock::now() - start;
+  spawnTime = elapsed.count();
 }
 
 void HexGrid::Update(const Camera2D &camera, float totalTime) {
   UpdateTileVisibility(totalTime);
 
-  for (const HexCoord &h : currentVisibleTiles) {
-    MapTile &tile = GetTile(h);
+  // Count down hit flashes
+  flashingTiles.EraseIf([totalTime](HexCoord, float &timer) {
+    timer -= totalTime;
+    return timer <= 0.0f;
+  });
 
-    // Initialise if undiscoverd and draw details
-    for (TileDet &d : tile.det) {
-      if (d.taOffsetX == conf::UNINITIALIZED) {
-        d = GetRandomTerainDetail(tile.id);
-      }
-    }
-
-    // Initialise if undiscoverd and draw resource
-    rsrc::Object &rsrc = tile.rsrc;
+  // Publish this frame's edits to background readers
+  chunks.Commit();
+  autosave.Update(totalTime);
+  UpdateStreaming(totalTime);
+}
 
-    if (rsrc.id == rsrc::UNINITIALIZED) {
-      rsrc = GetRandomTerainResource(tile.id, tile.posWorld);
-    }
-    if (rsrc.id != rsrc::ID_NULL) {
-      if (rsrc.flashTimer > 0.0f) {
-        rsrc.flashTimer -= totalTime;
-        if (rsrc.flashTimer < 0.0f)
-          rsrc.flashTimer = 0.0f;
-      }
-    }
+Vector2 HexGrid::Rebase(Vector2 focus) {
+  float dx = focus.x - origin.x;
+  float dy = focus.y - origin.y;
+  if (dx * dx + dy * dy <
+      conf::ORIGIN_REBASE_DISTANCE * conf::ORIGIN_REBASE_DISTANCE) {
+    return {0, 0};
   }
+  HexCoord anchor = PointToHexCoord(focus);
+  Vector2 anchorPoint = HexCoordToPoint(anchor);
+  originTile = anchor;
+
+  // Visible windows and flashes are kept in tiles, they stay valid
+  return {anchorPoint.x - origin.x, anchorPoint.y - origin.y};
 }
 
 void HexGrid::Shutdown() {
-  if (visiCalcFuture.valid()) {
-    visiCalcFuture.wait();
+  streamer.Stop();
+  {
+    std::lock_guard<std::mutex> lock(visiRequestMutex);
+    visiWorkerRunning = false;
+  }
+  visiRequestCV.notify_one();
+  if (visiWorker.joinable()) {
+    visiWorker.join();
   }
+  chunks.Commit();
+  autosave.Stop();
+  chunks.Flush();
 }
 
 bool HexGrid::RemoveResource(HexCoord h, int id) {
-  if (!HasTile(h)) {
+  if (!HasTile(h) || pack::DecodeResourceID(PeekResource(h)) != id) {
     return false;
   }
-  MapTile &tile = GetTile(h);
-  rsrc::Object &rsrc = tile.rsrc;
-  if (rsrc.id == id) {
-    rsrc.id = rsrc::ID_NULL;
-    return true;
-  }
-  return false;
+  rsrc::Object rsrc = ReadResource(h);
+  rsrc.id = rsrc::ID_NULL;
+  WriteResource(h, rsrc);
+  return true;
 }
 
 bool HexGrid::DamageResource(HexCoord h, int id, int damage) {
-  if (!HasTile(h)) {
+  if (!HasTile(h) || pack::DecodeResourceID(PeekResource(h)) != id) {
     return false;
   }
-  MapTile &tile = GetTile(h);
-  rsrc::Object &rsrc = tile.rsrc;
-  if (rsrc.id == id) {
-    rsrc.hp -= damage;
-    rsrc.flashTimer = 0.15f; // Flash for 150ms
+  rsrc::Object rsrc = ReadResource(h);
+  rsrc.hp -= damage;
 
-    if (rsrc.hp <= 0) {
-      rsrc.id = rsrc::ID_NULL;
-      return true;
-    }
-    return false;
+  // Flash for 150ms
+  flashingTiles[h] = 0.15f;
+
+  bool destroyed = rsrc.hp <= 0;
+  if (destroyed) {
+    rsrc.id = rsrc::ID_NULL;
   }
-  return false;
+  WriteResource(h, rsrc);
+  return destroyed;
 }
 
 bool HexGrid::CheckObstacleCollision(Vector2 worldPos, float radius) {
   HexCoord centerHex = PointToHexCoord(worldPos);
 
-  // Check the center tile and all 6 neighbors
-  std::vector<HexCoord> neighbors;
-  neighbors.push_back(centerHex);
-  for (int i = 0; i < 6; i++) {
-    neighbors.push_back(GetNeighbor(centerHex, i));
+  // Most steps have no obstacle in reach, 3 masked words tell
+  if (!tileBits.AnyInRange(tilebits::BLOCKS, centerHex, 1)) {
+    return false;
   }
 
-  for (const HexCoord &h : neighbors) {
-    if (!HasTile(h))
-      continue;
-
-    const MapTile &tile = GetTile(h);
-
-    const rsrc::Object &rsrc = tile.rsrc;
-    if (rsrc.id != rsrc::UNINITIALIZED && rsrc.id != rsrc::ID_NULL) {
-      if (rsrc.id == rsrc::ID_TREE) {
+  // Check the center tile and all 6 neighbors
+  for (HexCoord h : hexmath::Spiral(centerHex, 1)) {
+    // Only trees block, skip decoding everything else
+    if (IsInBounds(h) && tileBits.Test(h, tilebits::BLOCKS)) {
 
-        Vector2 treePos = rsrc.worldPos;
+      Vector2 treePos =
+          pack::DecodeResource(PeekResource(h), HexCoordToPoint(h)).worldPos;
 
-        if (CheckCollisionCircles(worldPos, radius, treePos,
-                                  conf::TREE_COLLISION_RADIUS)) {
-          return true;
-        }
+      if (CheckCollisionCircles(worldPos, radius, treePos,
+                                conf::TREE_COLLISION_RADIUS)) {
+        return true;
       }
     }
   }
   return false;
 }
 
-// --- Graphics / Backbuffer ---
-void HexGrid::LoadBackBuffer() {
-  for (const HexCoord &h : currentVisibleTiles) {
+// --- Save / Load ---
+// Only edited chunks are written, everything else follows from the seed.
+bool HexGrid::Save(std::ostream &out) const {
+  SaveWorldHeader header = {(u16)chunk::SHIFT, chunk::TILE_ORDER, mapRadius,
+                            worldSeed};
+  out.write((const char *)&header, sizeof(header));
+  return out.good() && chunks.Save(out);
+}
 
-    MapTile &tile = GetTile(h);
-    tile::id id = tile.id;
+bool HexGrid::ReadSave(std::istream &in, WorldSave &save) {
+  auto start = std::chrono::high_resolution_clock::now();
 
-    Vector2 tileCenter = HexCoordToPoint(h);
-    Vector2 renderPos = Vector2{tileCenter.x - tex::size::HALF_TILE,
-                                tileCenter.y - tex::size::HALF_TILE};
+  SaveWorldHeader &header = save.header;
+  in.read((char *)&header, sizeof(header));
+  if (!in || header.chunkShift != (u16)chunk::SHIFT ||
+      header.tileOrder != chunk::TILE_ORDER || header.mapRadius != mapRadius) {
+    return false;
+  }
+  bool isRead = chunks.ReadSave(in, save.blocks);
 
-    Rectangle destRec = Rectangle{.x = renderPos.x,
-                                  .y = renderPos.y,
-                                  .width = tex::size::TILE,
-                                  .height = tex::size::TILE};
+  std::chrono::duration<double, std::milli> elapsed =
+      std::chrono::high_resolution_clock::now() - start;
+  loadTime = elapsed.count();
+  return isRead;
+}
 
-    // Draw chached visible tiles
-    LoadTileGFX(destRec, animationFrame + 12, id);
+void HexGrid::ApplySave(WorldSave &save) {
+  auto start = std::chrono::high_resolution_clock::now();
 
-    // 'destRec' needs to be repostion, details and resource assets are
-    // begining at the bottom
-    destRec.y -= tex::size::HALF_TILE;
+  // Bakes depend on the seed, the worker must be idle before it changes
+  streamer.Clear();
+  worldSeed = save.header.seed;
+  flashingTiles.Clear();
+  chunks.ApplySave(save.blocks);
+  tileBits.Clear();
 
-    // Draw details
-    for (TileDet &d : tile.det) {
-      if (d.taOffsetX != conf::SKIP_RENDER &&
-          d.taOffsetX != conf::UNINITIALIZED) {
-        LoadDetailGFX(destRec, d, tile.id);
-      }
+  // Loaded chunks match the save, they are not pending for the journal
+  std::vector<int> loadedSlots;
+  chunks.TakeDirtySlots(loadedSlots);
+
+  std::chrono::duration<double, std::milli> elapsed =
+      std::chrono::high_resolution_clock::now() - start;
+  loadTime += elapsed.count();
+}
+
+void HexGrid::ResetAutosave() { autosave.Reset(); }
+
+int HexGrid::ReplayAutosave() {
+  streamer.Clear();
+  int replayed = autosave.Replay();
+  tileBits.Clear();
+  return replayed;
+}
+
+// --- Graphics / Backbuffer ---
+void HexGrid::LoadBackBuffer() {
+  streamMisses = 0;
+  const VisibleWindow &w = currentVisibleWindow;
+  for (int r = w.rMin; r <= w.rMax; r++) {
+    // Whole row at once, the tile centers of a span only differ in q
+    int qMin = w.qMin[r - w.rMin];
+    int count = w.qMax[r - w.rMin] - qMin + 1;
+    if (count <= 0) {
+      continue;
     }
+    rowPointsX.resize(count);
+    rowPointsY.resize(count);
+    hexmath::RowToPoints(hexLayout, qMin - originTile.q, r - originTile.r,
+                         count, rowPointsX.data(), rowPointsY.data());
+    for (int i = 0; i < count; i++) {
+      LoadTileBackBuffer(HexCoord(qMin + i, r),
+                         {rowPointsX[i], rowPointsY[i]});
+    }
+  }
+}
+
+void HexGrid::LoadTileBackBuffer(HexCoord h, Vector2 tileCenter) {
+  tile::id id = PeekID(h);
+  if (id == tile::NULL_ID) {
+    return;
+  }
+  if (streamer.Find(chunks.SlotIndex(h.q, h.r)) == nullptr) {
+    streamMisses++;
+  }
 
-    // Draw resource
-    rsrc::Object &rsrc = tile.rsrc;
-    if (rsrc.id != rsrc::ID_NULL && rsrc.id != rsrc::UNINITIALIZED) {
-      LoadResourceGFX(destRec, rsrc, tile.id);
+  Vector2 renderPos = Vector2{tileCenter.x - tex::size::HALF_TILE,
+                              tileCenter.y - tex::size::HALF_TILE};
+
+  Rectangle destRec = Rectangle{.x = renderPos.x,
+                                .y = renderPos.y,
+                                .width = tex::size::TILE,
+                                .height = tex::size::TILE};
+
+  // Draw chached visible tiles
+  LoadTileGFX(destRec, animationFrame + 12, id);
+
+  // 'destRec' needs to be repostion, details and resource assets are
+  // begining at the bottom
+  destRec.y -= tex::size::HALF_TILE;
+
+  // Draw details
+  TileDet det[conf::TERRAIN_DETAILS_MAX];
+  ReadDetails(h, det);
+  for (int i = 0; i < conf::TERRAIN_DETAILS_MAX; i++) {
+    const TileDet &d = det[i];
+    if (d.taOffsetX != conf::SKIP_RENDER &&
+        d.taOffsetX != conf::UNINITIALIZED) {
+      LoadDetailGFX(destRec, d, id);
     }
   }
+
+  // Draw resource
+  pack::Resource bits = PeekResource(h);
+  if (pack::DecodeResourceID(bits) >= 0) {
+    LoadResourceGFX(destRec, pack::DecodeResource(bits, tileCenter), id);
+  }
 }
 
 void HexGrid::DrawTile(HexCoord h, tex::atlas::Coords taCoords,
@@ -250,9 +382,8 @@ void HexGrid::DrawTile(HexCoord h, tex::atlas::Coords taCoords,
   pos.x -= conf::TILE_RESOLUTION_HALF;
   pos.y -= conf::TILE_RESOLUTION_HALF;
 
-  tex::Opts opts;
-  opts.origin = {0.0f, 0.0f};
-  graphicsManager->LoadTextureToBackbuffer(layerID, taCoords, pos, opts);
+  graphicsManager->LoadSpriteToBackbuffer(
+      layerID, graphicsManager->GetAtlasSprite(taCoords), pos);
 }
 
 // --- Setters ---
@@ -262,21 +393,26 @@ void HexGrid::SetGFX_Manager(GFX_Manager *graphicsManager) {
 
 void HexGrid::SetCamRectPointer(Rectangle *camRect) { this->camRect = camRect; }
 
+void HexGrid::SetPrefetchVelocity(Vector2 velocity) {
+  prefetchVelocity = velocity;
+}
+
 bool HexGrid::SetTile(HexCoord h, tile::id id) {
   if (!IsInBounds(h) || HexCoordToType(h) == id) {
     return false;
 
   } else {
-    MapTile &tile = GetTile(h);
-    tile.id = id;
-    if (id != tile::NULL_ID) {
-      for (TileDet &det : tile.det) {
-        det = GetRandomTerainDetail(id);
-      }
+    chunk::Chunk *c = AcquireChunk(h);
+    if (c == nullptr) {
+      return false;
     }
-    rsrc::Object &rsrc = tile.rsrc;
-    // r = GetRandomTerainResource(id);
-    rsrc = rsrc::OBJECT_NULL;
+    int i = chunks.LocalIndex(h.q, h.r);
+    streamer.Invalidate(chunks.SlotIndex(h.q, h.r));
+    // Details follow the new id, they are derived from it
+    c->SetID(i, id);
+    c->SetResource(
+        i, pack::EncodeResource(rsrc::OBJECT_NULL, HexCoordToPoint(h)));
+    UpdateTileBits(h);
 
     return true;
   }
@@ -284,43 +420,81 @@ bool HexGrid::SetTile(HexCoord h, tile::id id) {
 }
 
 // --- Getters ---
-int HexGrid::GetTilesInUse() const { return tilesInUse; }
-int HexGrid::GetTilesInTotal() const { return tilesInTotal; }
-int HexGrid::GetTilesVisible() const { return currentVisibleTiles.size(); }
+int HexGrid::GetTilesInUse() const {
+  return IsUnbounded() ? GetTilesInTotal() : tilesInUse;
+}
+// Cells the directory can address: the explored regions of an unbounded
+// world, or the trimmed directory including the parts of the border chunks
+// that stick out of the hexagon.
+int HexGrid::GetTilesInTotal() const {
+  return chunks.GetChunkSlots() * chunk::TILES;
+}
+int HexGrid::GetTilesVisible() const { return currentVisibleWindow.tileCount; }
+const std::vector<HexCoord> &HexGrid::GetEnteredTiles() const {
+  return enteredTiles;
+}
+const std::vector<HexCoord> &HexGrid::GetExitedTiles() const {
+  return exitedTiles;
+}
+int HexGrid::GetChunksLoaded() const { return chunks.GetChunksLoaded(); }
+size_t HexGrid::GetTileMemoryUsage() const { return chunks.GetBytesInUse(); }
 int HexGrid::GetMapRadius() const { return mapRadius; }
+HexCoord HexGrid::GetOriginTile() const { return originTile; }
+bool HexGrid::IsUnbounded() const { return mapRadius == 0; }
 double HexGrid::GetVisCalcTime() const { return calcVisTime; }
+double HexGrid::GetVisLatency() const { return visLatency; }
+double HexGrid::GetLoadTime() const { return loadTime; }
+double HexGrid::GetSpawnTime() const { return spawnTime; }
+double HexGrid::GetAutosaveSnapshotTime() const {
+  return autosave.GetSnapshotTime();
+}
+size_t HexGrid::GetAutosaveBytesWritten() const {
+  return autosave.GetBytesWritten();
+}
+int HexGrid::GetChunksBaked() const { return streamer.GetChunksBaked(); }
+double HexGrid::GetStreamBakeTime() const { return streamer.GetBakeTime(); }
+int HexGrid::GetStreamMisses() const { return streamMisses; }
+int HexGrid::GetChunksEvicted() const { return chunks.GetChunksEvicted(); }
+int HexGrid::GetEvictCount() const { return chunks.GetEvictCount(); }
+int HexGrid::GetReloadCount() const { return chunks.GetReloadCount(); }
+double HexGrid::GetEvictTime() const { return chunks.GetEvictTime(); }
+double HexGrid::GetReloadTime() const { return chunks.GetReloadTime(); }
+int HexGrid::GetChunksPacked() const { return chunks.GetChunksPacked(); }
+size_t HexGrid::GetPackedBytes() const { return chunks.GetPackedBytes(); }
+double HexGrid::GetPackRate() const { return chunks.GetPackRate(); }
+double HexGrid::GetUnpackRate() const { return chunks.GetUnpackRate(); }
 rsrc::Object HexGrid::GetResource(HexCoord h) const {
-  MapTile tile = this->GetTile(h);
-  return tile.rsrc;
+  if (!IsInBounds(h)) {
+    return rsrc::OBJECT_NULL;
+  }
+  return ReadResource(h);
 }
 
 bool HexGrid::IsInBounds(HexCoord h) const {
-  int s = -h.q - h.r;
-  return abs(h.q) <= mapRadius && abs(h.r) <= mapRadius && abs(s) <= mapRadius;
+  if (IsUnbounded()) {
+    return true;
+  }
+  return hexmath::Length(h) <= mapRadius;
 }
 
 bool HexGrid::HasTile(HexCoord h) const {
   if (!IsInBounds(h)) {
     return false;
   }
-  return GetTile(h).id != tile::NULL_ID;
+  return PeekID(h) != tile::NULL_ID;
 }
 
 bool HexGrid::IsWalkable(HexCoord h) const {
-  if (!HasTile(h)) {
-    return false;
-  }
-  const MapTile *tile = HexCoordToTile(h);
-  if (!tile)
-    return false;
+  return IsInBounds(h) && tileBits.Test(h, tilebits::WALKABLE);
+}
 
-  tile::id type = tile->id;
-  for (int i = 0; i < conf::WALKABLE_TILE_IDS.size(); i++) {
-    if (type == conf::WALKABLE_TILE_IDS[i]) {
-      return true;
-    }
-  }
-  return false;
+bool HexGrid::HasResourceInRange(HexCoord center, int radius) const {
+  return tileBits.AnyInRange(tilebits::HAS_RESOURCE, center, radius);
+}
+
+int HexGrid::CountTilesInRange(HexCoord center, int radius,
+                               tilebits::Layer layer) const {
+  return tileBits.CountInRange(layer, center, radius);
 }
 
 bool HexGrid::CheckSurrounded(HexCoord target) const {
@@ -331,11 +505,10 @@ bool HexGrid::CheckSurrounded(HexCoord target) const {
   int neighborCount = 0;
   int wallCount = 0;
 
-  for (int i = 0; i < 6; i++) {
-    HexCoord n = GetNeighbor(target, i);
+  for (HexCoord n : hexmath::Ring(target, 1)) {
     if (IsInBounds(n)) {
       neighborCount++;
-      if (GetTile(n).id == tile::NULL_ID) {
+      if (PeekID(n) == tile::NULL_ID) {
         wallCount++;
       }
     }
@@ -344,70 +517,43 @@ bool HexGrid::CheckSurrounded(HexCoord target) const {
 }
 
 // --- Conversions / Helpers ---
-HexCoord HexGrid::HexRound(FractionalHex h) const {
-  int q = std::round(h.q);
-  int r = std::round(h.r);
-  int s = std::round(h.s);
-  double q_diff = std::abs(q - h.q);
-  double r_diff = std::abs(r - h.r);
-  double s_diff = std::abs(s - h.s);
-  if (q_diff > r_diff && q_diff > s_diff)
-    q = -r - s;
-  else if (r_diff > s_diff)
-    r = -q - s;
-  return HexCoord(q, r);
-}
-
 Vector2 HexGrid::HexCoordToPoint(HexCoord h) const {
   return CoordToPoint(h.q, h.r);
 }
 
 Vector2 HexGrid::CoordToPoint(int q, int r) const {
-  float x = tileGapX * (std::sqrt(3.0f) * q + std::sqrt(3.0f) / 2.0f * r);
-  float y = tileGapY * (3.0f / 2.0f * r);
-  return {x + origin.x, y + origin.y};
+  return CoordToPoint(q, r, originTile);
 }
 
 tile::id HexGrid::PointToType(Vector2 point) const {
-  const MapTile *tile = PointToTile(point);
-  return tile ? tile->id : tile::NULL_ID;
+  return HexCoordToType(PointToHexCoord(point));
 }
 
 tile::id HexGrid::HexCoordToType(HexCoord h) const {
-  const MapTile *m = HexCoordToTile(h);
-  return m ? m->id : tile::NULL_ID;
+  return IsInBounds(h) ? PeekID(h) : tile::NULL_ID;
 }
 
-MapTile *HexGrid::HexCoordToTile(HexCoord h) {
+MapTile HexGrid::HexCoordToTile(HexCoord h) const {
+  MapTile tile = {.id = tile::NULL_ID, .rsrc = rsrc::OBJECT_NULL};
   if (!IsInBounds(h)) {
-    return nullptr;
+    return tile;
   }
-  return &GetTile(h);
+  tile.id = PeekID(h);
+  ReadDetails(h, tile.det);
+  tile.rsrc = ReadResource(h);
+  tile.posWorld = HexCoordToPoint(h);
+  return tile;
 }
 
-const MapTile *HexGrid::HexCoordToTile(HexCoord h) const {
-  if (!IsInBounds(h)) {
-    return nullptr;
-  }
-  return &GetTile(h);
-}
-
-MapTile *HexGrid::PointToTile(Vector2 point) {
-  HexCoord h = PointToHexCoord(point);
-  return HexCoordToTile(h);
-}
-
-const MapTile *HexGrid::PointToTile(Vector2 point) const {
+MapTile HexGrid::PointToTile(Vector2 point) const {
   HexCoord h = PointToHexCoord(point);
   return HexCoordToTile(h);
 }
 
 HexCoord HexGrid::PointToHexCoord(Vector2 point) const {
-  float pt_x = (point.x - origin.x) / tileGapX;
-  float pt_y = (point.y - origin.y) / tileGapY;
-  double q = (std::sqrt(3.0) / 3.0 * pt_x - 1.0 / 3.0 * pt_y);
-  double r = (2.0 / 3.0 * pt_y);
-  return HexRound({q, r, -q - r});
+  HexCoord h;
+  hexmath::ToCoord(hexLayout, point.x, point.y, h.q, h.r);
+  return h + originTile;
 }
 
 const char *HexGrid::TileToString(tile::id id) const {
@@ -426,51 +572,204 @@ const char *HexGrid::TileToString(tile::id id) const {
 }
 
 HexCoord HexGrid::GetNeighbor(HexCoord h, int directionIndex) const {
-  return h + DIRECTIONS[directionIndex];
+  return hexmath::Neighbor(h, directionIndex);
 }
 
 // --- Private Methods ---
-const MapTile &HexGrid::GetTile(HexCoord h) const {
-  return tileData[(h.r + mapRadius) * gridSize + (h.q + mapRadius)];
+// Chunks only hold deviations, tiles that were never written merge in the
+// base world: GRASS inside the hexagon.
+tile::id HexGrid::PeekID(HexCoord h) const {
+  const chunk::Chunk *c = chunks.Find(h.q, h.r);
+  u8 id = c != nullptr ? c->GetID(chunks.LocalIndex(h.q, h.r)) : chunk::BASE_ID;
+  if (id == chunk::BASE_ID) {
+    return IsInBounds(h) ? tile::GRASS : tile::NULL_ID;
+  }
+  return (tile::id)id;
 }
 
-MapTile &HexGrid::GetTile(HexCoord h) {
-  return tileData[(h.r + mapRadius) * gridSize + (h.q + mapRadius)];
+tile::id HexGrid::PeekID(const WorldSnapshot *snap, HexCoord h) const {
+  const chunk::Chunk *c = snap->Find(h.q, h.r);
+  u8 id = c != nullptr ? c->GetID(chunks.LocalIndex(h.q, h.r)) : chunk::BASE_ID;
+  if (id == chunk::BASE_ID) {
+    return IsInBounds(h) ? tile::GRASS : tile::NULL_ID;
+  }
+  return (tile::id)id;
 }
 
-TileDet HexGrid::GetRandomTerainDetail(tile::id id) {
-  float x = GetRandomValue(-tex::size::QUATER_TILE, tex::size::QUATER_TILE);
-  float y = GetRandomValue(-tex::size::QUATER_TILE, tex::size::QUATER_TILE);
+// Only modified resources are stored, untouched ones are rolled from the
+// world seed on every read.
+pack::Resource HexGrid::PeekResource(HexCoord h) const {
+  const chunk::Chunk *c = chunks.Find(h.q, h.r);
+  if (c != nullptr) {
+    pack::Resource bits = c->GetResource(chunks.LocalIndex(h.q, h.r));
+    if (bits != pack::RESOURCE_PRISTINE) {
+      return bits;
+    }
+  }
+  const BakedChunk *b = streamer.Find(chunks.SlotIndex(h.q, h.r));
+  if (b != nullptr) {
+    return b->rsrc[chunks.LocalIndex(h.q, h.r)];
+  }
+  Vector2 tileCenter = HexCoordToPoint(h);
+  return pack::EncodeResource(RollTerainResource(h, PeekID(h), tileCenter),
+                              tileCenter);
+}
 
-  auto spawnData = spawn_data_det::detLut.at(id);
+void HexGrid::ReadDetails(HexCoord h,
+                          TileDet det[conf::TERRAIN_DETAILS_MAX]) const {
+  const BakedChunk *b = streamer.Find(chunks.SlotIndex(h.q, h.r));
+  if (b != nullptr) {
+    const TileDet *baked = b->det[chunks.LocalIndex(h.q, h.r)];
+    std::copy(baked, baked + conf::TERRAIN_DETAILS_MAX, det);
+    return;
+  }
+  tile::id id = PeekID(h);
+  for (int i = 0; i < conf::TERRAIN_DETAILS_MAX; i++) {
+    det[i] = RollTerainDetail(h, id, i);
+  }
+}
+
+rsrc::Object HexGrid::ReadResource(HexCoord h) const {
+  rsrc::Object rsrc = pack::DecodeResource(PeekResource(h), HexCoordToPoint(h));
+  rsrc.flashTimer = GetFlashTimer(h);
+  return rsrc;
+}
+
+void HexGrid::WriteResource(HexCoord h, const rsrc::Object &rsrc) {
+  chunk::Chunk *c = AcquireChunk(h);
+  if (c == nullptr) {
+    return;
+  }
+  c->SetResource(chunks.LocalIndex(h.q, h.r),
+                 pack::EncodeResource(rsrc, HexCoordToPoint(h)));
+  UpdateTileBits(h);
+}
+
+float HexGrid::GetFlashTimer(HexCoord h) const {
+  const float *timer = flashingTiles.Find(h);
+  return timer != nullptr ? *timer : 0.0f;
+}
+
+// PeekID() and PeekResource() for a whole chunk, the chunk lookups are
+// done once. Tiles outside the map have no bits set.
+void HexGrid::BuildTileBits(int cq, int cr, tilebits::ChunkBits &bits) const {
+  int q0 = chunks.ChunkOrigin(cq);
+  int r0 = chunks.ChunkOrigin(cr);
+  bits = tilebits::ChunkBits();
+  const chunk::Chunk *c = nullptr;
+  const BakedChunk *b = nullptr;
+  bool isLookedUp = false;
+  for (int lr = 0; lr < chunk::SIZE; lr++) {
+    for (int lq = 0; lq < chunk::SIZE; lq++) {
+      HexCoord h(q0 + lq, r0 + lr);
+      if (!IsInBounds(h)) {
+        continue;
+      }
+      if (!isLookedUp) {
+        c = chunks.Find(h.q, h.r);
+        b = streamer.Find(chunks.SlotIndex(h.q, h.r));
+        isLookedUp = true;
+      }
+      int i = chunks.LocalIndex(h.q, h.r);
+      u8 storedID = c != nullptr ? c->GetID(i) : chunk::BASE_ID;
+      pack::Resource stored =
+          c != nullptr ? c->GetResource(i) : pack::RESOURCE_PRISTINE;
+      tile::id id =
+          storedID == chunk::BASE_ID ? tile::GRASS : (tile::id)storedID;
+
+      rsrc::ID rsrcID;
+      if (stored != pack::RESOURCE_PRISTINE) {
+        rsrcID = pack::DecodeResourceID(stored);
+      } else if (b != nullptr) {
+        rsrcID = pack::DecodeResourceID(b->rsrc[i]);
+      } else {
+        rsrcID = RollTerainResource(h, id, {0, 0}).id;
+      }
+
+      tilebits::Row bit = (tilebits::Row)1 << lq;
+      if (IsWalkableID(id)) {
+        bits.rows[tilebits::WALKABLE][lr] |= bit;
+      }
+      if (rsrcID >= 0) {
+        bits.rows[tilebits::HAS_RESOURCE][lr] |= bit;
+      }
+      if (rsrcID == rsrc::ID_TREE) {
+        bits.rows[tilebits::BLOCKS][lr] |= bit;
+      }
+      if (storedID != chunk::BASE_ID || stored != pack::RESOURCE_PRISTINE) {
+        bits.rows[tilebits::MODIFIED][lr] |= bit;
+      }
+    }
+  }
+}
+
+// Call after every write to 'h'.
+void HexGrid::UpdateTileBits(HexCoord h) {
+  tile::id id = PeekID(h);
+  rsrc::ID rsrcID = pack::DecodeResourceID(PeekResource(h));
+  tileBits.Set(h, tilebits::WALKABLE, IsWalkableID(id));
+  tileBits.Set(h, tilebits::HAS_RESOURCE, rsrcID >= 0);
+  tileBits.Set(h, tilebits::BLOCKS, rsrcID == rsrc::ID_TREE);
+  tileBits.Set(h, tilebits::MODIFIED, true);
+}
+
+chunk::Chunk *HexGrid::AcquireChunk(HexCoord h) {
+  chunk::Chunk *c = chunks.Edit(h.q, h.r);
+  if (c == nullptr) {
+    c = new chunk::Chunk;
+    if (!chunks.Publish(h.q, h.r, c)) {
+      return nullptr;
+    }
+  }
+  return c;
+}
+
+// Rolls are hashed from (seed, q, r, id), so they are stable across runs and
+// safe to call from any thread.
+TileDet HexGrid::RollTerainDetail(HexCoord h, tile::id id, int index) const {
+  if (id == tile::NULL_ID) {
+    return TileDet{.tilePos = Vector2{0, 0}, .taOffsetX = conf::SKIP_RENDER};
+  }
+  int quater = (int)tex::size::QUATER_TILE;
+  u32 salt = index * 4;
+  float x = HashRange(TileHash(worldSeed, h, id, salt), -quater, quater);
+  float y = HashRange(TileHash(worldSeed, h, id, salt + 1), -quater, quater);
+
+  const auto &spawnData = spawn_data_det::detLut.at(id);
 
   int totalWeight = conf::TOTAL_WEIGHT_DET;
   int taOffsetX = conf::SKIP_RENDER;
-  int index = GetRandomValue(0, spawnData.size() - 1);
+  int kind = HashRange(TileHash(worldSeed, h, id, salt + 2), 0,
+                       spawnData.size() - 1);
 
-  int randNum = GetRandomValue(0, totalWeight);
-  if (randNum <= spawnData[index]) {
-    taOffsetX = index;
+  int randNum = HashRange(TileHash(worldSeed, h, id, salt + 3), 0, totalWeight);
+  if (randNum <= spawnData[kind]) {
+    taOffsetX = kind;
   }
 
   return TileDet{.tilePos = Vector2{x, y}, .taOffsetX = taOffsetX};
 }
 
-rsrc::Object HexGrid::GetRandomTerainResource(tile::id id,
-                                              Vector2 tileWorldPos) {
+rsrc::Object HexGrid::RollTerainResource(HexCoord h, tile::id id,
+                                         Vector2 tileCenter) const {
+  if (id == tile::NULL_ID) {
+    return rsrc::OBJECT_NULL;
+  }
+  // Salts above the detail rolls
+  u32 salt = conf::TERRAIN_DETAILS_MAX * 4;
 
-  auto spawnData = rsrc::TILE_LUT.at(id);
+  rsrc::Object spawnData = rsrc::TILE_LUT.at(id);
 
-  float x = GetRandomValue(-conf::SPAWN_RSRC_SPREAD, conf::SPAWN_RSRC_SPREAD);
-  float y = GetRandomValue(-conf::SPAWN_RSRC_SPREAD, conf::SPAWN_RSRC_SPREAD);
+  int spread = (int)conf::SPAWN_RSRC_SPREAD;
+  float x = HashRange(TileHash(worldSeed, h, id, salt), -spread, spread);
+  float y = HashRange(TileHash(worldSeed, h, id, salt + 1), -spread, spread);
 
-  spawnData.worldPos = {tileWorldPos.x + x, tileWorldPos.y + y};
+  spawnData.worldPos = {tileCenter.x + x, tileCenter.y + y};
 
   int totalWeight = conf::TOTAL_WEIGHT_RSRC;
   rsrc::Object rsrc = rsrc::OBJECT_NULL;
-  int index = GetRandomValue(0, totalWeight);
 
-  int randNum = GetRandomValue(0, totalWeight);
+  int randNum = HashRange(TileHash(worldSeed, h, id, salt + 2), 0, totalWeight);
   if (randNum <= spawnData.spawn_chance) {
     rsrc = spawnData;
   }
@@ -478,49 +777,77 @@ rsrc::Object HexGrid::GetRandomTerainResource(tile::id id,
   return rsrc;
 }
 
-void HexGrid::CalcVisibleTiles() {
-  auto start = std::chrono::high_resolution_clock::now();
-  if (camRect == nullptr) {
-    return;
+// Relative to 'anchor' instead of the current origin tile, for threads that
+// work on a camera rect of an earlier frame.
+Vector2 HexGrid::CoordToPoint(int q, int r, HexCoord anchor) const {
+  // Integer offsets first, floats only see the distance to the anchor
+  return hexmath::ToPoint(hexLayout, q - anchor.q, r - anchor.r);
+}
+
+void HexGrid::VisibilityWorkerLoop() {
+  while (true) {
+    Rectangle camView;
+    HexCoord anchor;
+    std::chrono::high_resolution_clock::time_point requestTime;
+    {
+      std::unique_lock<std::mutex> lock(visiRequestMutex);
+      visiRequestCV.wait(
+          lock, [this] { return visiRequestPending || !visiWorkerRunning; });
+      if (!visiWorkerRunning) {
+        return;
+      }
+      camView = visiRequestRect;
+      anchor = visiRequestAnchor;
+      requestTime = visiRequestTime;
+      visiRequestPending = false;
+    }
+    CalcVisibleTiles(camView, anchor, requestTime);
   }
-  // Define the rendering view rectangle, expanded by an offset for culling.
-  Rectangle renderView = {
-      .x = camRect->x - conf::RENDER_VIEW_CULLING_MARGIN,
-      .y = camRect->y - conf::RENDER_VIEW_CULLING_MARGIN,
-      .width = camRect->width + conf::RENDER_VIEW_CULLING_EXPANSION,
-      .height = camRect->height + conf::RENDER_VIEW_CULLING_EXPANSION};
+}
 
-  int gridSize = mapRadius * 2 + 1;
+void HexGrid::RequestVisibleTiles(Rectangle camView) {
+  {
+    std::lock_guard<std::mutex> lock(visiRequestMutex);
+    visiRequestRect = camView;
+    visiRequestAnchor = originTile;
+    visiRequestTime = std::chrono::high_resolution_clock::now();
+    visiRequestPending = true;
+  }
+  visiRequestCV.notify_one();
+}
 
-  std::vector<HexCoord> newVisiCache;
-  newVisiCache.reserve(conf::ESTIMATED_VISIBLE_TILES); // Pre-allocate memory
-                                                       // for efficiency.
+void HexGrid::CalcVisibleTiles(
+    Rectangle camView, HexCoord anchor,
+    std::chrono::high_resolution_clock::time_point requestTime) {
+  auto start = std::chrono::high_resolution_clock::now();
 
-  // Iterate over all tiles in the grid.
-  for (u16 r = 0; r < gridSize; r++) {
-    for (u16 q = 0; q < gridSize; q++) {
+  VisibleWindow window;
+  CalcVisibleWindow(CalcRenderView(camView), anchor, window);
 
-      if (tileData[r * gridSize + q].id == tile::NULL_ID) {
-        continue;
-      }
-      // Convert grid coordinates to HexCoord and then to screen coordinates.
-      HexCoord h(q - mapRadius, r - mapRadius);
-      Vector2 pos = HexCoordToPoint(h);
-      pos.x -= conf::TILE_RESOLUTION_HALF;
-      pos.y -= conf::TILE_RESOLUTION_HALF;
-      Rectangle dest_rect = {pos.x, pos.y, tex::size::TILE, tex::size::TILE};
-      // Check if the tile's bounding box intersects with the render view.
-      if (CheckCollisionRecs(renderView, dest_rect)) {
-        newVisiCache.push_back(h);
-      }
-    }
+  // Read tiles from a pinned snapshot, the logic thread keeps writing to its
+  // own copies meanwhile.
+  const WorldSnapshot *snap = chunks.AcquireSnapshot(visiReaderID);
+
+  // Emit only what changed since the previous window
+  if (!conf::VISIBILITY_DELTA_ENABLED) {
+    prevVisibleWindow = VisibleWindow();
   }
-  // Lock the mutex to safely swap the newly calculated visible tiles into the
-  // nextVisibleTiles. std::lock_guard ensures the mutex is unlocked when
+  std::vector<HexCoord> entered;
+  std::vector<HexCoord> exited;
+  DiffVisibleWindows(snap, prevVisibleWindow, window, entered);
+  DiffVisibleWindows(snap, window, prevVisibleWindow, exited);
+  prevVisibleWindow = window;
+  chunks.ReleaseSnapshot(visiReaderID);
+
+  // Lock the mutex to safely swap the newly calculated window into the
+  // back buffer. std::lock_guard ensures the mutex is unlocked when
   // exiting this scope.
   std::lock_guard<std::mutex> lock(visiCacheMutex);
-  nextVisibleTiles =
-      std::move(newVisiCache); // Move the new data to the back buffer.
+  nextVisibleWindow = std::move(window);
+  nextEnteredTiles.insert(nextEnteredTiles.end(), entered.begin(),
+                          entered.end());
+  nextExitedTiles.insert(nextExitedTiles.end(), exited.begin(), exited.end());
+  nextVisibleRequestTime = requestTime;
   visiCacheReady = true; // Signal that new data is ready for the main thread.
 
   auto end = std::chrono::high_resolution_clock::now();
@@ -528,55 +855,272 @@ void HexGrid::CalcVisibleTiles() {
   calcVisTime = elapsed.count();
 }
 
+// Rendering view rectangle, expanded by an offset for culling.
+Rectangle HexGrid::CalcRenderView(Rectangle camView) const {
+  return Rectangle{
+      .x = camView.x - conf::RENDER_VIEW_CULLING_MARGIN,
+      .y = camView.y - conf::RENDER_VIEW_CULLING_MARGIN,
+      .width = camView.width + conf::RENDER_VIEW_CULLING_EXPANSION,
+      .height = camView.height + conf::RENDER_VIEW_CULLING_EXPANSION};
+}
+
+/* Inverse of CoordToPoint, restricted to the axis we need, with q and r
+ * relative to the anchor tile:
+ *   y = origin.y + tileGapY * 3/2 * r             ->  r from y
+ *   x = origin.x + tileGapX * sqrt(3) * (q + r/2) ->  q from x and r
+ * A tile covers +-TILE_RESOLUTION_HALF around its center.
+ */
+void HexGrid::CalcVisibleRows(Rectangle view, HexCoord anchor, int &rMin,
+                              int &rMax) const {
+  float rowHeight = hexLayout.rowHeight;
+  float top = view.y - conf::TILE_RESOLUTION_HALF - origin.y;
+  float bot = view.y + view.height + conf::TILE_RESOLUTION_HALF - origin.y;
+
+  rMin = (int)std::floor(top / rowHeight) + anchor.r;
+  rMax = (int)std::ceil(bot / rowHeight) + anchor.r;
+  if (!IsUnbounded()) {
+    rMin = std::max(rMin, -mapRadius);
+    rMax = std::min(rMax, mapRadius);
+  }
+}
+
+void HexGrid::CalcVisibleCols(Rectangle view, HexCoord anchor, int r,
+                              int &qMin, int &qMax) const {
+  float colWidth = hexLayout.colWidth;
+  float left = view.x - conf::TILE_RESOLUTION_HALF - origin.x;
+  float right = view.x + view.width + conf::TILE_RESOLUTION_HALF - origin.x;
+  float halfRow = (r - anchor.r) * 0.5f;
+
+  qMin = (int)std::floor(left / colWidth - halfRow) + anchor.q;
+  qMax = (int)std::ceil(right / colWidth - halfRow) + anchor.q;
+  // Clamp to the hexagon: |q| <= R and |q + r| <= R
+  if (!IsUnbounded()) {
+    qMin = std::max(qMin, std::max(-mapRadius, -mapRadius - r));
+    qMax = std::min(qMax, std::min(mapRadius, mapRadius - r));
+  }
+}
+
+void HexGrid::CalcVisibleWindow(Rectangle view, HexCoord anchor,
+                                VisibleWindow &w) const {
+  // Same test as CheckCollisionRecs against the tile's bounding box, split
+  // per axis so padded rows and columns can be trimmed independently.
+  auto rowVisible = [&](int r) {
+    float y = CoordToPoint(anchor.q, r, anchor).y - conf::TILE_RESOLUTION_HALF;
+    return view.y < y + tex::size::TILE && view.y + view.height > y;
+  };
+  auto colVisible = [&](int q, int r) {
+    float x = CoordToPoint(q, r, anchor).x - conf::TILE_RESOLUTION_HALF;
+    return view.x < x + tex::size::TILE && view.x + view.width > x;
+  };
+
+  int rMin, rMax;
+  CalcVisibleRows(view, anchor, rMin, rMax);
+  while (rMin <= rMax && !rowVisible(rMin)) {
+    rMin++;
+  }
+  while (rMax >= rMin && !rowVisible(rMax)) {
+    rMax--;
+  }
+
+  w.rMin = rMin;
+  w.rMax = rMax;
+  w.qMin.clear();
+  w.qMax.clear();
+  w.tileCount = 0;
+
+  for (int r = rMin; r <= rMax; r++) {
+    int qMin, qMax;
+    CalcVisibleCols(view, anchor, r, qMin, qMax);
+    while (qMin <= qMax && !colVisible(qMin, r)) {
+      qMin++;
+    }
+    while (qMax >= qMin && !colVisible(qMax, r)) {
+      qMax--;
+    }
+    w.qMin.push_back(qMin);
+    w.qMax.push_back(qMax);
+    w.tileCount += std::max(qMax - qMin + 1, 0);
+  }
+}
+
+// Collects the tiles of 'to' that are not part of 'from'. Rows are compared
+// span by span, so the cost is the number of rows plus the delta.
+void HexGrid::DiffVisibleWindows(const WorldSnapshot *snap,
+                                 const VisibleWindow &from,
+                                 const VisibleWindow &to,
+                                 std::vector<HexCoord> &out) const {
+  for (int r = to.rMin; r <= to.rMax; r++) {
+    int fromMin = 1;
+    int fromMax = 0;
+    if (r >= from.rMin && r <= from.rMax) {
+      fromMin = from.qMin[r - from.rMin];
+      fromMax = from.qMax[r - from.rMin];
+    }
+
+    for (int q = to.qMin[r - to.rMin]; q <= to.qMax[r - to.rMin]; q++) {
+      if (q >= fromMin && q <= fromMax) {
+        q = fromMax; // Skip the overlap
+        continue;
+      }
+      HexCoord h(q, r);
+      if (PeekID(snap, h) != tile::NULL_ID) {
+        out.push_back(h);
+      }
+    }
+  }
+}
+
 void HexGrid::UpdateTileVisibility(float totalTime) {
+  // Deltas are only valid for the frame they were swapped in
+  enteredTiles.clear();
+  exitedTiles.clear();
+
   // Check if the asynchronous calculation of visible tiles is complete
   if (visiCacheReady) {
 
     // Lock the mutex to safely swap the current rendering cache
     std::lock_guard<std::mutex> lock(visiCacheMutex);
-    currentVisibleTiles.swap(nextVisibleTiles); // Atomically swap the buffers.
-    nextVisibleTiles.clear(); // Clear the now-empty back buffer.
-    visiCacheReady = false;   // Reset the flag.
-  }
-
-  // Check if a previous asynchronous calculation is still running.
-  // If not valid (first run) or finished, launch a new one.
-  if (!visiCalcFuture.valid() || visiCalcFuture.wait_for(std::chrono::seconds(
-                                     0)) == std::future_status::ready) {
-
-    bool cameraMoved = false;
-    if (camRect != nullptr) {
-      if (camRect->x != lastCamRect.x || camRect->y != lastCamRect.y ||
-          camRect->width != lastCamRect.width ||
-          camRect->height != lastCamRect.height) {
-        cameraMoved = true;
-      }
-    }
+    std::swap(currentVisibleWindow, nextVisibleWindow);
+    enteredTiles.swap(nextEnteredTiles);
+    exitedTiles.swap(nextExitedTiles);
+    visiCacheReady = false; // Reset the flag.
+
+    std::chrono::duration<double, std::milli> latency =
+        std::chrono::high_resolution_clock::now() - nextVisibleRequestTime;
+    visLatency = latency.count();
+  }
 
-    if (cameraMoved || !visiCalcFuture.valid()) {
-      if (camRect != nullptr) {
-        lastCamRect = *camRect;
-      }
-      // Launch CalcVisibleTiles asynchronously in a separate thread.
-      // std::launch::async ensures it runs on a new thread immediately.
-      visiCalcFuture =
-          std::async(std::launch::async, &HexGrid::CalcVisibleTiles, this);
-    } else {
-      calcVisTime = 0.0;
+  // Post the camera rect to the worker whenever it changed. Requests are
+  // coalesced, the worker always picks up the latest one.
+  bool cameraMoved = false;
+  if (camRect != nullptr) {
+    if (camRect->x != lastCamRect.x || camRect->y != lastCamRect.y ||
+        camRect->width != lastCamRect.width ||
+        camRect->height != lastCamRect.height) {
+      cameraMoved = true;
     }
   }
 
+  if (camRect != nullptr && (cameraMoved || !visiRequestedOnce)) {
+    lastCamRect = *camRect;
+    visiRequestedOnce = true;
+    RequestVisibleTiles(lastCamRect);
+  } else {
+    calcVisTime = 0.0;
+  }
+
   // Update animation frame based on game time for animated tiles.
   animationFrame = (int)(totalTime * tex::atlas::TILES_ANIMATION_SPEED) % 1;
 }
 
 void HexGrid::UpdateTilesProperties() {}
 
+// Wants the chunks under the render view first, then the ones the view
+// reaches within STREAM_LOOKAHEAD seconds at the current velocity. Wanted
+// chunks stay in memory, the others may be evicted.
+void HexGrid::UpdateStreaming(float deltaTime) {
+  if (camRect == nullptr) {
+    return;
+  }
+  Rectangle view = CalcRenderView(*camRect);
+  Rectangle ahead = view;
+  ahead.x += prefetchVelocity.x * conf::STREAM_LOOKAHEAD;
+  ahead.y += prefetchVelocity.y * conf::STREAM_LOOKAHEAD;
+
+  streamWanted.clear();
+  CollectChunks(view, streamWanted);
+  CollectChunks(ahead, streamWanted);
+
+  // Cold chunks come back before background readers look at them
+  int loaded = chunks.GetChunksLoaded();
+  for (const StreamRequest &w : streamWanted) {
+    chunks.Touch(w.slot);
+  }
+  if (chunks.GetChunksLoaded() != loaded) {
+    chunks.Commit();
+  }
+
+  evictTimer += deltaTime;
+  if (evictTimer >= conf::CHUNK_EVICT_PERIOD) {
+    evictTimer = 0.0f;
+    coldSlots.clear();
+    if (conf::COLD_CHUNK_COMPRESSION) {
+      chunks.PackCold(conf::CHUNK_COLD_AGE, coldSlots);
+    }
+    chunks.EvictToBudget(conf::TILE_MEMORY_BUDGET, conf::TILE_MEMORY_TARGET,
+                         coldSlots);
+    // A bake still in flight would read them as the base world
+    for (int slot : coldSlots) {
+      streamer.Invalidate(slot);
+    }
+    chunks.Commit();
+    // Cold chunks keep their bits, the layers have a budget of their own
+    tileBits.Trim(conf::TILE_BITS_MAX_CHUNKS);
+  }
+
+  if (conf::CHUNK_STREAMING_ENABLED) {
+    streamer.Update(streamWanted);
+  }
+}
+
+// Appends the chunks overlapping 'view' that are not in 'out' yet. Chunks
+// are parallelograms, a chunk row covers the q spans of its first and last
+// tile row. Unbounded worlds give seen chunks their slots here.
+void HexGrid::CollectChunks(Rectangle view, std::vector<StreamRequest> &out) {
+  int rMin, rMax;
+  CalcVisibleRows(view, originTile, rMin, rMax);
+  if (rMin > rMax) {
+    return;
+  }
+  for (int cr = chunks.ChunkCoord(rMin); cr <= chunks.ChunkCoord(rMax); cr++) {
+    int rLo = std::max(chunks.ChunkOrigin(cr), rMin);
+    int rHi = std::min(chunks.ChunkOrigin(cr) + chunk::MASK, rMax);
+    int qMinLo, qMaxLo, qMinHi, qMaxHi;
+    CalcVisibleCols(view, originTile, rLo, qMinLo, qMaxLo);
+    CalcVisibleCols(view, originTile, rHi, qMinHi, qMaxHi);
+    int qMin = std::min(qMinLo, qMinHi);
+    int qMax = std::max(qMaxLo, qMaxHi);
+    if (qMin > qMax) {
+      continue;
+    }
+
+    for (int cq = chunks.ChunkCoord(qMin); cq <= chunks.ChunkCoord(qMax);
+         cq++) {
+      int slot = chunks.AcquireSlot(cq, cr);
+      auto known = std::find_if(
+          out.begin(), out.end(),
+          [slot](const StreamRequest &w) { return w.slot == slot; });
+      if (known == out.end()) {
+        out.push_back({slot, cq, cr, 0});
+      }
+    }
+  }
+}
+
+// Runs on the streaming worker. Same rolls as ReadDetails and PeekResource,
+// tile ids come from the pinned snapshot. Resource offsets do not depend on
+// the tile position, they are rolled around (0, 0) so the worker never
+// reads the floating origin.
+void HexGrid::BakeChunk(const WorldSnapshot *snap, BakedChunk &b) const {
+  int q0 = chunks.ChunkOrigin(b.cq);
+  int r0 = chunks.ChunkOrigin(b.cr);
+  for (int i = 0; i < chunk::TILES; i++) {
+    int lq, lr;
+    chunk::TileCoords(i, lq, lr);
+    HexCoord h(q0 + lq, r0 + lr);
+    tile::id id = IsInBounds(h) ? PeekID(snap, h) : tile::NULL_ID;
+    for (int d = 0; d < conf::TERRAIN_DETAILS_MAX; d++) {
+      b.det[i][d] = RollTerainDetail(h, id, d);
+    }
+    b.rsrc[i] =
+        pack::EncodeResource(RollTerainResource(h, id, {0, 0}), {0, 0});
+  }
+}
+
 void HexGrid::LoadTileGFX(Rectangle destRec, int x, int y) {
-  tex::Opts opts;
-  opts.origin = {0.0f, 0.0f};
-  graphicsManager->LoadTextureToBackbuffer(drawMask::GROUND0, {x, y},
-                                           {destRec.x, destRec.y}, opts);
+  graphicsManager->LoadSpriteToBackbuffer(
+      drawMask::GROUND0, graphicsManager->GetAtlasSprite({x, y}),
+      {destRec.x, destRec.y});
 }
 
 void HexGrid::LoadDetailGFX(Rectangle destRec, const TileDet detail,
@@ -584,10 +1128,9 @@ void HexGrid::LoadDetailGFX(Rectangle destRec, const TileDet detail,
   destRec.x += detail.tilePos.x;
   destRec.y += detail.tilePos.y;
   int taX = tex::atlas::DETAILS_X + detail.taOffsetX;
-  tex::Opts opts;
-  opts.origin = {0.0f, 0.0f};
-  graphicsManager->LoadTextureToBackbuffer(drawMask::ON_GROUND, {taX, id},
-                                           {destRec.x, destRec.y}, opts);
+  graphicsManager->LoadSpriteToBackbuffer(
+      drawMask::ON_GROUND, graphicsManager->GetAtlasSprite({taX, id}),
+      {destRec.x, destRec.y});
 }
 
 void HexGrid::LoadResourceGFX(Rectangle destRec, const rsrc::Object rsrc,
@@ -2,6 +2,8 @@
 #include "defines.h"
 #include "enums.h"
 #include "item_db.h"
+#include <istream>
+#include <ostream>
 
 // --- Constructors ---
 ItemHandler::ItemHandler() { Init(); }
@@ -59,6 +61,34 @@ bool ItemHandler::AddItem(item::id itemID, int count) {
   return false;
 }
 
+// --- Save / Load ---
+bool ItemHandler::Save(std::ostream &out) const {
+  u32 containerCount = 2;
+  out.write((const char *)&containerCount, sizeof(containerCount));
+  SaveContainer(out, toolBar);
+  SaveContainer(out, inventory);
+  return out.good();
+}
+
+bool ItemHandler::Load(std::istream &in) {
+  u32 containerCount = 0;
+  in.read((char *)&containerCount, sizeof(containerCount));
+  if (!in || containerCount != 2) {
+    return false;
+  }
+
+  // Keep the current items if the save is damaged
+  ItemContainer loadedToolBar = toolBar;
+  ItemContainer loadedInventory = inventory;
+  if (!LoadContainer(in, loadedToolBar) ||
+      !LoadContainer(in, loadedInventory)) {
+    return false;
+  }
+  toolBar = loadedToolBar;
+  inventory = loadedInventory;
+  return true;
+}
+
 // --- Setters ---
 void ItemHandler::SetFrameContext(const frame::Context *curFrameContext) {
   this->frameContext = curFrameContext;
@@ -130,3 +160,29 @@ void ItemHandler::Init() {
   inventory[17] = grass;
   inventory[15] = dirt;
 }
+
+void ItemHandler::SaveContainer(std::ostream &out, const ItemContainer &c) {
+  u32 stackCount = (u32)c.size();
+  out.write((const char *)&stackCount, sizeof(stackCount));
+  for (const ItemStack &stack : c) {
+    s32 fields[2] = {(s32)stack.itemID, (s32)stack.count};
+    out.write((const char *)fields, sizeof(fields));
+  }
+}
+
+// Container sizes are fixed, extra stacks in the save are dropped.
+bool ItemHandler::LoadContainer(std::istream &in, ItemContainer &c) {
+  u32 stackCount = 0;
+  in.read((char *)&stackCount, sizeof(stackCount));
+  for (u32 i = 0; in && i < stackCount; i++) {
+    s32 fields[2];
+    in.read((char *)fields, sizeof(fields));
+    if (!in || item_db::DB.count((item::id)fields[0]) == 0) {
+      return false;
+    }
+    if (i < c.size()) {
+      c[i] = {.itemID = (item::id)fields[0], .count = fields[1]};
+    }
+  }
+  return (bool)in;
+}
@@ -0,0 +1,72 @@
+#include "map_tile.h"
+#include "defines.h"
+#include "resource.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+constexpr int RSRC_ID_BITS = 2;
+constexpr int RSRC_HP_BITS = 7;
+constexpr int RSRC_POS_BITS = 3;
+constexpr int RSRC_POS_BIAS = (int)conf::SPAWN_RSRC_SPREAD;
+
+constexpr u32 Mask(int bits) { return (1u << bits) - 1; }
+
+static_assert(RSRC_ID_BITS + RSRC_HP_BITS + 2 * RSRC_POS_BITS <= 16,
+              "Resource does not fit pack::Resource");
+static_assert(rsrc::OBJECT_TREE.hp <= (int)Mask(RSRC_HP_BITS) &&
+                  rsrc::OBJECT_ROCK.hp <= (int)Mask(RSRC_HP_BITS),
+              "Resource hp does not fit");
+static_assert(2 * RSRC_POS_BIAS <= (int)Mask(RSRC_POS_BITS),
+              "Resource position does not fit");
+
+// Rounds 'v' to an integer and stores it biased into 'bits' bits
+u32 PackSigned(float v, int bias, int bits) {
+  int biased = (int)std::lround(v) + bias;
+  return (u32)std::clamp(biased, 0, (int)Mask(bits));
+}
+} // namespace
+
+namespace pack {
+
+// --- Resource ---
+Resource EncodeResource(const rsrc::Object &rsrc, Vector2 tileCenter) {
+  u32 id = (u32)(rsrc.id - rsrc::UNINITIALIZED);
+  u32 hp = (u32)std::clamp(rsrc.hp, 0, (int)Mask(RSRC_HP_BITS));
+  u32 x = 0;
+  u32 y = 0;
+  if (rsrc.id >= 0) {
+    x = PackSigned(rsrc.worldPos.x - tileCenter.x, RSRC_POS_BIAS,
+                   RSRC_POS_BITS);
+    y = PackSigned(rsrc.worldPos.y - tileCenter.y, RSRC_POS_BIAS,
+                   RSRC_POS_BITS);
+  }
+
+  return (Resource)(id | hp << RSRC_ID_BITS |
+                    x << (RSRC_ID_BITS + RSRC_HP_BITS) |
+                    y << (RSRC_ID_BITS + RSRC_HP_BITS + RSRC_POS_BITS));
+}
+
+rsrc::Object DecodeResource(Resource bits, Vector2 tileCenter) {
+  rsrc::ID id = DecodeResourceID(bits);
+  if (id < 0) {
+    rsrc::Object rsrc = rsrc::OBJECT_NULL;
+    rsrc.id = id;
+    return rsrc;
+  }
+
+  int x = (int)(bits >> (RSRC_ID_BITS + RSRC_HP_BITS) & Mask(RSRC_POS_BITS));
+  int y = (int)(bits >> (RSRC_ID_BITS + RSRC_HP_BITS + RSRC_POS_BITS) &
+                Mask(RSRC_POS_BITS));
+
+  rsrc::Object rsrc = rsrc::ID_LUT[id];
+  rsrc.hp = (int)(bits >> RSRC_ID_BITS & Mask(RSRC_HP_BITS));
+  rsrc.worldPos = {tileCenter.x + (x - RSRC_POS_BIAS),
+                   tileCenter.y + (y - RSRC_POS_BIAS)};
+  return rsrc;
+}
+
+rsrc::ID DecodeResourceID(Resource bits) {
+  return (rsrc::ID)((int)(bits & Mask(RSRC_ID_BITS)) + rsrc::UNINITIALIZED);
+}
+} // namespace pack
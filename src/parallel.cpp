@@ -0,0 +1,32 @@
+#include "parallel.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace parallel {
+
+int GetWorkerCount() {
+  return std::max(1, (int)std::thread::hardware_concurrency());
+}
+
+void For(int count, const std::function<void(int, int)> &fn) {
+  // Items are handed out one at a time, their cost varies a lot
+  std::atomic<int> next(0);
+  auto run = [&](int worker) {
+    for (int i = next++; i < count; i = next++) {
+      fn(i, worker);
+    }
+  };
+
+  int workers = std::min(GetWorkerCount(), count);
+  std::vector<std::thread> threads;
+  for (int w = 1; w < workers; w++) {
+    threads.emplace_back(run, w);
+  }
+  run(0);
+  for (std::thread &t : threads) {
+    t.join();
+  }
+}
+} // namespace parallel
@@ -15,6 +15,7 @@
 Player::Player() {
   position = conf::SCREEN_CENTER;
   previousPosition = position;
+  velocity = {0, 0};
   speedTilesPerSecond = 0.0f;
   faceDirID = faceDir::S;
   stateID = playerState::IDLE;
@@ -51,8 +52,11 @@ void Player::Update() {
   float distance = Vector2Distance(position, previousPosition);
   if (frameContext->deltaTime > 0) {
     moveSpeed = distance / frameContext->deltaTime / conf::TILE_RESOLUTION;
+    velocity = Vector2Scale(Vector2Subtract(position, previousPosition),
+                            1.0f / frameContext->deltaTime);
   } else {
     moveSpeed = 0;
+    velocity = {0, 0};
   }
   previousPosition = position;
 }
@@ -125,6 +129,13 @@ void Player::SetFrameContext(const frame::Context *frameContext) {
   this->frameContext = frameContext;
 }
 
+void Player::Shift(Vector2 offset) {
+  position.x -= offset.x;
+  position.y -= offset.y;
+  previousPosition.x -= offset.x;
+  previousPosition.y -= offset.y;
+}
+
 // --- Getters ---
 Vector2 Player::GetPosition() const { return position; }
 
@@ -134,6 +145,8 @@ int Player::GetAnimationFrame() const { return animationFrame; }
 
 float Player::GetSpeedTilesPerSecond() const { return moveSpeed; }
 
+Vector2 Player::GetVelocity() const { return velocity; }
+
 const char *Player::PlayerStateToString() const {
   switch (stateID) {
   case playerState::NULL_ID:
@@ -0,0 +1,215 @@
+#include "tile_bits.h"
+#include "chunk_store.h"
+#include "defines.h"
+#include "hex_math.h"
+#include <algorithm>
+#include <bitset>
+#include <limits>
+#include <utility>
+#include <vector>
+
+// --- Constructors ---
+TileBits::TileBits() {
+  useClock = 0;
+  lastEntry = -1;
+  chunks = nullptr;
+}
+
+// --- Core Lifecycle ---
+void TileBits::Init(const ChunkStore *chunks, BuildFunc build) {
+  this->chunks = chunks;
+  this->build = build;
+  Clear();
+}
+
+void TileBits::Clear() {
+  index.Clear();
+  entries.clear();
+  entryChunks.clear();
+  lastUsed.clear();
+  lastEntry = -1;
+}
+
+void TileBits::Trim(int maxChunks) {
+  useClock++;
+  if ((int)entries.size() <= maxChunks) {
+    return;
+  }
+  using Age = std::pair<u32, HexCoord>;
+  std::vector<Age> byAge;
+  byAge.reserve(entries.size());
+  for (size_t i = 0; i < entries.size(); i++) {
+    byAge.push_back({lastUsed[i], entryChunks[i]});
+  }
+  std::sort(byAge.begin(), byAge.end(),
+            [](const Age &a, const Age &b) { return a.first < b.first; });
+  int excess = (int)entries.size() - maxChunks / 4 * 3;
+  for (int i = 0; i < excess; i++) {
+    Drop(byAge[i].second);
+  }
+}
+
+// --- Queries ---
+bool TileBits::Test(HexCoord h, tilebits::Layer layer) {
+  int cq = chunks->ChunkCoord(h.q);
+  int cr = chunks->ChunkCoord(h.r);
+  int lq = h.q - chunks->ChunkOrigin(cq);
+  int lr = h.r - chunks->ChunkOrigin(cr);
+  return (Acquire(cq, cr).rows[layer][lr] >> lq) & 1;
+}
+
+int TileBits::CountRow(tilebits::Layer layer, int r, int qMin, int qMax) {
+  return CountIn(layer, r, r, [qMin, qMax](int, int &lo, int &hi) {
+    lo = qMin;
+    hi = qMax;
+  });
+}
+
+bool TileBits::AnyInRow(tilebits::Layer layer, int r, int qMin, int qMax) {
+  return AnyIn(layer, r, r, [qMin, qMax](int, int &lo, int &hi) {
+    lo = qMin;
+    hi = qMax;
+  });
+}
+
+// Row r of the range covers q in [max(-radius, -dr - radius),
+// min(radius, -dr + radius)] around the center, like hexmath::Range.
+int TileBits::CountInRange(tilebits::Layer layer, HexCoord center,
+                           int radius) {
+  return CountIn(layer, center.r - radius, center.r + radius,
+                 [center, radius](int r, int &lo, int &hi) {
+                   int dr = r - center.r;
+                   lo = center.q + std::max(-radius, -dr - radius);
+                   hi = center.q + std::min(radius, -dr + radius);
+                 });
+}
+
+bool TileBits::AnyInRange(tilebits::Layer layer, HexCoord center,
+                          int radius) {
+  return AnyIn(layer, center.r - radius, center.r + radius,
+               [center, radius](int r, int &lo, int &hi) {
+                 int dr = r - center.r;
+                 lo = center.q + std::max(-radius, -dr - radius);
+                 hi = center.q + std::min(radius, -dr + radius);
+               });
+}
+
+// --- Setters ---
+void TileBits::Set(HexCoord h, tilebits::Layer layer, bool isSet) {
+  int cq = chunks->ChunkCoord(h.q);
+  int cr = chunks->ChunkCoord(h.r);
+  int *entry = index.Find(HexCoord(cq, cr));
+  if (entry == nullptr) {
+    return;
+  }
+  tilebits::Row bit = (tilebits::Row)1 << (h.q - chunks->ChunkOrigin(cq));
+  tilebits::Row &word =
+      entries[*entry].rows[layer][h.r - chunks->ChunkOrigin(cr)];
+  word = isSet ? word | bit : word & ~bit;
+}
+
+// --- Getters ---
+int TileBits::GetChunksBuilt() const { return (int)entries.size(); }
+
+size_t TileBits::GetBytes() const {
+  return index.GetBytes() +
+         entries.capacity() * sizeof(tilebits::ChunkBits) +
+         entryChunks.capacity() * sizeof(HexCoord) +
+         lastUsed.capacity() * sizeof(u32);
+}
+
+// --- Private Methods ---
+const tilebits::ChunkBits &TileBits::Acquire(int cq, int cr) {
+  HexCoord chunkCoords(cq, cr);
+  if (lastEntry >= 0 && lastChunk == chunkCoords) {
+    return entries[lastEntry];
+  }
+  const int *entry = index.Find(chunkCoords);
+  lastChunk = chunkCoords;
+  if (entry != nullptr) {
+    lastEntry = *entry;
+    lastUsed[*entry] = useClock;
+    return entries[*entry];
+  }
+  lastEntry = (int)entries.size();
+  index.Insert(chunkCoords, lastEntry);
+  entries.emplace_back();
+  entryChunks.push_back(chunkCoords);
+  lastUsed.push_back(useClock);
+  build(cq, cr, entries.back());
+  return entries.back();
+}
+
+// The last entry moves into the hole.
+void TileBits::Drop(HexCoord chunkCoords) {
+  int entry = *index.Find(chunkCoords);
+  index.Erase(chunkCoords);
+  lastEntry = -1;
+  int last = (int)entries.size() - 1;
+  if (entry != last) {
+    entries[entry] = entries[last];
+    entryChunks[entry] = entryChunks[last];
+    lastUsed[entry] = lastUsed[last];
+    index[entryChunks[entry]] = entry;
+  }
+  entries.pop_back();
+  entryChunks.pop_back();
+  lastUsed.pop_back();
+}
+
+// Calls fn(word) with the masked word of every chunk row that rows 'rMin'
+// to 'rMax' touch, until it returns false. span(r, qMin, qMax) gives the
+// tiles of row r. Each chunk is looked up once. Returns false if fn
+// stopped early.
+template <typename Span, typename Fn>
+bool TileBits::ForEachWord(tilebits::Layer layer, int rMin, int rMax,
+                           Span span, Fn fn) {
+  for (int cr = chunks->ChunkCoord(rMin); cr <= chunks->ChunkCoord(rMax);
+       cr++) {
+    int r0 = chunks->ChunkOrigin(cr);
+    int rLo = std::max(rMin, r0);
+    int rHi = std::min(rMax, r0 + chunk::MASK);
+    int qLo = std::numeric_limits<int>::max();
+    int qHi = std::numeric_limits<int>::min();
+    for (int r = rLo; r <= rHi; r++) {
+      int lo, hi;
+      span(r, lo, hi);
+      qLo = std::min(qLo, lo);
+      qHi = std::max(qHi, hi);
+    }
+    if (qLo > qHi) {
+      continue;
+    }
+    for (int cq = chunks->ChunkCoord(qLo); cq <= chunks->ChunkCoord(qHi);
+         cq++) {
+      int q0 = chunks->ChunkOrigin(cq);
+      const tilebits::Row *rows = Acquire(cq, cr).rows[layer];
+      for (int r = rLo; r <= rHi; r++) {
+        int lo, hi;
+        span(r, lo, hi);
+        lo = std::max(lo - q0, 0);
+        hi = std::min(hi - q0, chunk::MASK);
+        if (lo <= hi && !fn(rows[r - r0] & tilebits::SpanMask(lo, hi))) {
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+template <typename Span>
+int TileBits::CountIn(tilebits::Layer layer, int rMin, int rMax, Span span) {
+  int count = 0;
+  ForEachWord(layer, rMin, rMax, span, [&count](tilebits::Row word) {
+    count += (int)std::bitset<32>(word).count();
+    return true;
+  });
+  return count;
+}
+
+template <typename Span>
+bool TileBits::AnyIn(tilebits::Layer layer, int rMin, int rMax, Span span) {
+  return !ForEachWord(layer, rMin, rMax, span,
+                      [](tilebits::Row word) { return word == 0; });
+}
@@ -0,0 +1,127 @@
+#include "world_file.h"
+#include "defines.h"
+#include <cstring>
+#include <iostream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define WORLD_FILE_MMAP 1
+#endif
+
+// --- Constructors ---
+WorldFile::WorldFile() {
+  fd = -1;
+  base = nullptr;
+  size = 0;
+  used = nullptr;
+  records = nullptr;
+  slots = 0;
+  recordSize = 0;
+}
+
+WorldFile::~WorldFile() { Close(); }
+
+// --- Core Lifecycle ---
+bool WorldFile::Open(const char *path, const WorldFileHeader &header) {
+  Close();
+#ifdef WORLD_FILE_MMAP
+  size_t recordsOffset = sizeof(WorldFileHeader) + header.slots;
+  recordsOffset += WORLD_FILE_PAGE - 1;
+  recordsOffset &= ~(WORLD_FILE_PAGE - 1);
+  size_t fileSize = recordsOffset + (size_t)header.slots * header.recordSize;
+
+  int file = open(path, O_RDWR | O_CREAT, 0644);
+  if (file < 0) {
+    std::cout << "Error opening world file " << path << std::endl;
+    return false;
+  }
+
+  struct stat st;
+  fstat(file, &st);
+  bool isNew = st.st_size == 0;
+  if (isNew && ftruncate(file, (off_t)fileSize) != 0) {
+    std::cout << "Error sizing world file " << path << std::endl;
+    close(file);
+    return false;
+  }
+  if (!isNew && (size_t)st.st_size != fileSize) {
+    std::cout << "World file " << path << " has a different layout"
+              << std::endl;
+    close(file);
+    return false;
+  }
+
+  void *map = mmap(nullptr, fileSize, PROT_READ | PROT_WRITE, MAP_SHARED, file,
+                   0);
+  if (map == MAP_FAILED) {
+    std::cout << "Error mapping world file " << path << std::endl;
+    close(file);
+    return false;
+  }
+
+  WorldFileHeader *stored = (WorldFileHeader *)map;
+  if (isNew) {
+    *stored = header;
+  } else if (std::memcmp(stored, &header, sizeof(WorldFileHeader)) != 0) {
+    std::cout << "World file " << path << " belongs to another world"
+              << std::endl;
+    munmap(map, fileSize);
+    close(file);
+    return false;
+  }
+
+  fd = file;
+  base = (u8 *)map;
+  size = fileSize;
+  used = base + sizeof(WorldFileHeader);
+  records = base + recordsOffset;
+  slots = header.slots;
+  recordSize = header.recordSize;
+  return true;
+#else
+  std::cout << "World files are not supported on this platform" << std::endl;
+  return false;
+#endif
+}
+
+void WorldFile::Close() {
+#ifdef WORLD_FILE_MMAP
+  if (base != nullptr) {
+    munmap(base, size);
+    close(fd);
+  }
+#endif
+  fd = -1;
+  base = nullptr;
+  size = 0;
+  used = nullptr;
+  records = nullptr;
+  slots = 0;
+  recordSize = 0;
+}
+
+// Schedules dirty pages for writing, does not wait for the disk.
+void WorldFile::Sync() {
+#ifdef WORLD_FILE_MMAP
+  if (base != nullptr) {
+    msync(base, size, MS_ASYNC);
+  }
+#endif
+}
+
+// --- Records ---
+bool WorldFile::IsUsed(int slot) const { return used[slot] != 0; }
+void WorldFile::MarkUsed(int slot) { used[slot] = 1; }
+void WorldFile::MarkFree(int slot) { used[slot] = 0; }
+void *WorldFile::Record(int slot) const {
+  return records + (size_t)slot * recordSize;
+}
+
+// --- Getters ---
+bool WorldFile::IsOpen() const { return base != nullptr; }
+bool WorldFile::Contains(const void *p) const {
+  return p >= (const void *)base && p < (const void *)(base + size);
+}